@@ -0,0 +1,178 @@
+#include "st3215/st3215.h"
+#include "st3215/group_sync_read.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <string>
+
+// Runs per-call measurements on a loopback port in whichever profile the
+// library was built with; behaviour is checked by tests/test_register_access.
+// Build it once with ST3215_EMBEDDED=OFF and once with ON (both MinSizeRel)
+// and compare.
+
+namespace {
+
+size_t allocations = 0;
+
+constexpr uint8_t SERVO_COUNT = 6;
+constexpr size_t CALLS = 20000;
+
+// Runs fn CALLS times, reports nanoseconds and allocations per call
+template <typename Fn>
+void measure(const char* name, Fn fn) {
+    using clock = std::chrono::steady_clock;
+    fn();  // Warm up buffers
+    size_t before = allocations;
+    auto start = clock::now();
+    for (size_t i = 0; i < CALLS; ++i) {
+        fn();
+    }
+    double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / CALLS;
+    double per_call = static_cast<double>(allocations - before) / CALLS;
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed
+              << std::setprecision(0) << std::setw(10) << ns
+              << std::setprecision(1) << std::setw(14) << per_call << std::endl;
+}
+
+// Answers every instruction at once with a fixed status packet, so the
+// measurements cover only the library and the PortHandler interface
+class LoopbackPort : public st3215::PortHandler {
+public:
+    LoopbackPort() : PortHandler("loopback") {}
+
+    bool openPort() override {
+        is_open_ = true;
+        tx_time_per_byte_ = 0.01;
+        return true;
+    }
+
+    void closePort() override { is_open_ = false; }
+
+    void clearPort() override { length_ = offset_ = 0; }
+
+    std::vector<uint8_t> readPort(size_t length) override {
+        size_t count = std::min(length, length_ - offset_);
+        std::vector<uint8_t> data(reply_.begin() + offset_, reply_.begin() + offset_ + count);
+        offset_ += count;
+        return data;
+    }
+
+    size_t writePort(const std::vector<uint8_t>& packet) override {
+        length_ = offset_ = 0;
+        uint8_t id = packet[st3215::PKT_ID];
+        uint8_t instruction = packet[st3215::PKT_INSTRUCTION];
+        if (instruction == st3215::INST_READ) {
+            addStatus(id, packet[st3215::PKT_PARAMETER0 + 1]);
+        } else if (instruction == st3215::INST_SYNC_READ) {
+            for (size_t i = st3215::PKT_PARAMETER0 + 2; i + 1 < packet.size(); ++i) {
+                addStatus(packet[i], packet[st3215::PKT_PARAMETER0 + 1]);
+            }
+        } else if (id != st3215::BROADCAST_ID) {
+            addStatus(id, 0);
+        }
+        return packet.size();
+    }
+
+private:
+    void addStatus(uint8_t id, uint8_t length) {
+        uint8_t* frame = reply_.data() + length_;
+        frame[0] = 0xFF;
+        frame[1] = 0xFF;
+        frame[2] = id;
+        frame[3] = length + 2;
+        frame[4] = 0;
+        uint8_t checksum = id + length + 2;
+        for (uint8_t i = 0; i < length; ++i) {
+            frame[5 + i] = 0x10 + i;
+            checksum += frame[5 + i];
+        }
+        frame[5 + length] = ~checksum;
+        length_ += 6 + length;
+    }
+
+    std::array<uint8_t, 1024> reply_{};
+    size_t length_ = 0;
+    size_t offset_ = 0;
+};
+
+size_t fileSize(const char* path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? static_cast<size_t>(file.tellg()) : 0;
+}
+
+std::string peakRss() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            size_t start = line.find_first_not_of(" \t", 6);
+            return (start == std::string::npos) ? "n/a" : line.substr(start);
+        }
+    }
+    return "n/a";
+}
+
+}  // namespace
+
+// Counting allocator; noinline keeps GCC from pairing the free() below with
+// a new-expression and warning about a mismatch
+__attribute__((noinline)) void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    std::abort();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main() {
+#ifdef ST3215_EMBEDDED
+    std::cout << "Profile:        embedded" << std::endl;
+#else
+    std::cout << "Profile:        default" << std::endl;
+#endif
+    std::cout << std::endl << std::left << std::setw(22) << "call" << std::right << std::setw(10) << "ns/call"
+              << std::setw(14) << "allocs/call" << std::endl;
+
+    // Per-call cost on the loopback port
+    auto loopback = st3215::ST3215::open(std::make_unique<LoopbackPort>());
+    if (!loopback) {
+        std::cerr << "Cannot open loopback port" << std::endl;
+        return 1;
+    }
+    st3215::GroupSyncRead loopback_read(loopback.get(), st3215::STS_PRESENT_POSITION_L, 2);
+    for (uint8_t id = 1; id <= SERVO_COUNT; ++id) {
+        loopback_read.addParam(id);
+    }
+
+    std::vector<uint8_t> goal = {50, 0, 0, 0, 0, 0xB0, 0x04};
+    measure("readPosition", [&]() { loopback->readPosition(1); });
+    measure("writePosition", [&]() { loopback->writePosition(1, 1000); });
+    measure("read2ByteTxRx", [&]() { loopback->read2ByteTxRx(1, st3215::STS_PRESENT_SPEED_L); });
+    measure("GroupSyncRead x6", [&]() { loopback_read.txRxPacket(); });
+    measure("GroupSyncWrite x6", [&]() {
+        for (uint8_t id = 1; id <= SERVO_COUNT; ++id) {
+            loopback->groupSyncWrite->addParam(id, goal);
+        }
+        loopback->groupSyncWrite->txPacket();
+        loopback->groupSyncWrite->clearParam();
+    });
+
+    std::cout << std::endl;
+    std::cout << "Binary size:    " << fileSize("/proc/self/exe") << " bytes" << std::endl;
+    std::cout << "Peak RSS:       " << peakRss() << std::endl;
+    std::cout << "(each readPort() call returns a vector, one allocation per read)" << std::endl;
+    return 0;
+}
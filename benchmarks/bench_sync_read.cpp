@@ -0,0 +1,117 @@
+#include "st3215/group_sync_read.h"
+#include "st3215/sync_read_scanner.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Compares the per-ID scalar search of GroupSyncRead::readRx() with the
+// SyncReadScanner fast path on well-formed sync read replies.
+
+namespace {
+
+std::vector<uint8_t> makeReply(const std::vector<uint8_t>& ids, uint8_t data_length) {
+    std::vector<uint8_t> reply;
+    for (uint8_t id : ids) {
+        size_t start = reply.size();
+        reply.insert(reply.end(), {0xFF, 0xFF, id, static_cast<uint8_t>(data_length + 2), 0});
+        for (uint8_t i = 0; i < data_length; ++i) {
+            reply.push_back(static_cast<uint8_t>(id * 31 + i * 7));
+        }
+        uint8_t checksum = 0;
+        for (size_t i = start + 2; i < reply.size(); ++i) {
+            checksum += reply[i];
+        }
+        reply.push_back(~checksum & 0xFF);
+    }
+    return reply;
+}
+
+// Runs fn until at least 50 ms have passed, returns nanoseconds per call
+template <typename Fn>
+double measure(Fn fn) {
+    using clock = std::chrono::steady_clock;
+    size_t iterations = 0;
+    auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+    while (elapsed < std::chrono::milliseconds(50)) {
+        for (int i = 0; i < 64; ++i) {
+            fn();
+        }
+        iterations += 64;
+        elapsed = clock::now() - start;
+    }
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+}  // namespace
+
+int main() {
+    const size_t counts[] = {8, 40, 100, 200};
+    const uint8_t lengths[] = {2, 15};
+    volatile uint32_t sink = 0;
+
+    std::cout << std::setw(7) << "servos" << std::setw(6) << "len" << std::setw(8) << "bytes"
+              << std::setw(12) << "scalar ns" << std::setw(12) << "scan ns" << std::setw(9) << "speedup"
+              << std::setw(14) << "wire 1M us" << std::setw(14) << "scan/wire 4M" << std::endl;
+
+    for (uint8_t data_length : lengths) {
+        for (size_t count : counts) {
+            std::vector<uint8_t> ids;
+            for (size_t i = 0; i < count; ++i) {
+                ids.push_back(static_cast<uint8_t>(i + 1));
+            }
+            std::vector<uint8_t> reply = makeReply(ids, data_length);
+
+            st3215::GroupSyncRead group(nullptr, st3215::STS_PRESENT_POSITION_L, data_length);
+            st3215::SyncReadScanner scanner;
+            scanner.reset(ids, data_length);
+
+            // Both paths must agree before timing them
+            if (!scanner.scan(reply)) {
+                std::cerr << "Scanner rejected a valid reply" << std::endl;
+                return 1;
+            }
+            std::vector<uint8_t> corrupt = reply;
+            corrupt[corrupt.size() / 2] ^= 0x01;
+            if (scanner.scan(corrupt)) {
+                std::cerr << "Scanner accepted a corrupt reply" << std::endl;
+                return 1;
+            }
+
+            std::vector<std::vector<uint8_t>> slots(count);
+
+            double scalar = measure([&]() {
+                for (size_t k = 0; k < count; ++k) {
+                    auto [data, result] = group.readRx(reply, ids[k], data_length);
+                    slots[k] = std::move(data);
+                    sink += result;
+                }
+            });
+
+            double scan = measure([&]() {
+                if (scanner.scan(reply)) {
+                    size_t stride = scanner.getStride();
+                    for (size_t k = 0; k < count; ++k) {
+                        slots[k].assign(reply.begin() + k * stride + st3215::PKT_ERROR,
+                                        reply.begin() + (k + 1) * stride - 1);
+                    }
+                }
+                sink += slots[0][0];
+            });
+
+            // 10 bits per byte
+            double wire_1m = reply.size() * 10.0;
+            double wire_4m = wire_1m / 4.0;
+
+            std::cout << std::setw(7) << count << std::setw(6) << static_cast<int>(data_length)
+                      << std::setw(8) << reply.size() << std::fixed << std::setprecision(0)
+                      << std::setw(12) << scalar << std::setw(12) << scan << std::setprecision(1)
+                      << std::setw(8) << scalar / scan << "x" << std::setw(14) << wire_1m
+                      << std::setw(13) << std::setprecision(2) << scan / (wire_4m * 10.0) << "%"
+                      << std::endl;
+        }
+    }
+
+    return sink == 0xFFFFFFFF ? 1 : 0;
+}
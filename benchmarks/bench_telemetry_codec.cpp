@@ -0,0 +1,97 @@
+#include "st3215/telemetry_codec.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+// Encodes one day of synthetic 100 Hz telemetry for one servo, then decodes
+// it, reporting size against fixed-width records and throughput.
+
+namespace {
+
+constexpr size_t SAMPLES_PER_DAY = 24 * 3600 * 100;
+constexpr size_t RAW_RECORD_SIZE = 8 + 4 * 4 + 2;  // Packed TelemetrySample
+
+std::vector<st3215::TelemetrySample> makeDay() {
+    std::mt19937 rng(3215);
+    std::uniform_int_distribution<int> jitter(-150, 150);
+    std::uniform_int_distribution<int> noise(-3, 3);
+
+    std::vector<st3215::TelemetrySample> samples(SAMPLES_PER_DAY);
+    int64_t timestamp = 0;
+    for (size_t n = 0; n < samples.size(); ++n) {
+        double t = n / 100.0;
+        double phase = 2.0 * M_PI * t / 4.0;  // 4 s back-and-forth moves
+        auto& sample = samples[n];
+
+        timestamp += 10000 + jitter(rng);
+        sample.timestamp = timestamp;
+        sample.position = static_cast<int32_t>(2048 + 1000 * std::sin(phase)) + noise(rng);
+        sample.speed = static_cast<int32_t>(1571 * std::cos(phase)) + noise(rng);
+        sample.load = static_cast<int32_t>(120 * std::cos(phase)) + noise(rng);
+        sample.current = 40 + noise(rng);
+        sample.voltage = (n / 6000) % 7 == 0 ? 119 : 120;
+        sample.temperature = static_cast<uint8_t>(35 + 5 * std::sin(2.0 * M_PI * t / 86400.0));
+    }
+    return samples;
+}
+
+bool equal(const st3215::TelemetrySample& a, const st3215::TelemetrySample& b) {
+    return a.timestamp == b.timestamp && a.position == b.position && a.speed == b.speed &&
+           a.load == b.load && a.current == b.current && a.voltage == b.voltage &&
+           a.temperature == b.temperature;
+}
+
+}  // namespace
+
+int main() {
+    using clock = std::chrono::steady_clock;
+    std::vector<st3215::TelemetrySample> day = makeDay();
+
+    st3215::TelemetryEncoder encoder(4096);
+    std::vector<uint8_t> stream;
+
+    auto start = clock::now();
+    for (const auto& sample : day) {
+        if (encoder.append(sample)) {
+            auto block = encoder.flush();
+            stream.insert(stream.end(), block.begin(), block.end());
+        }
+    }
+    auto block = encoder.flush();
+    stream.insert(stream.end(), block.begin(), block.end());
+    double encode_s = std::chrono::duration<double>(clock::now() - start).count();
+
+    // Decode once to fault in the output pages, then time a second pass
+    std::vector<st3215::TelemetrySample> decoded;
+    bool ok = st3215::TelemetryDecoder::decode(stream, decoded);
+    decoded.clear();
+    start = clock::now();
+    ok = ok && st3215::TelemetryDecoder::decode(stream, decoded);
+    double decode_s = std::chrono::duration<double>(clock::now() - start).count();
+
+    if (!ok || decoded.size() != day.size()) {
+        std::cerr << "Decode failed" << std::endl;
+        return 1;
+    }
+    for (size_t n = 0; n < day.size(); ++n) {
+        if (!equal(day[n], decoded[n])) {
+            std::cerr << "Mismatch at sample " << n << std::endl;
+            return 1;
+        }
+    }
+
+    double raw = static_cast<double>(day.size() * RAW_RECORD_SIZE);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Samples:        " << day.size() << " (one day at 100 Hz)" << std::endl;
+    std::cout << "Raw size:       " << raw / 1e6 << " MB (" << RAW_RECORD_SIZE << " B/sample)" << std::endl;
+    std::cout << "Encoded size:   " << stream.size() / 1e6 << " MB ("
+              << static_cast<double>(stream.size()) / day.size() << " B/sample, "
+              << raw / stream.size() << "x)" << std::endl;
+    std::cout << "Encode:         " << encode_s * 1e9 / day.size() << " ns/sample" << std::endl;
+    std::cout << "Decode:         " << decode_s * 1e3 << " ms for the day ("
+              << decode_s * 1e9 / day.size() << " ns/sample)" << std::endl;
+    return 0;
+}
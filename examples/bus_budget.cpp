@@ -0,0 +1,96 @@
+#include "st3215/dry_run.h"
+#include "st3215/bus_cost_model.h"
+#include "st3215/group_sync_read.h"
+#include "st3215/group_sync_write.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+
+// Checks whether a "sync read positions, sync write goals" loop fits the bus
+// for several baudrates and servo counts, without hardware.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <period_ms> <return_delay_us> [servo_count...]" << std::endl;
+        std::cerr << "Example: " << argv[0] << " 5 20 6 12 24" << std::endl;
+        return 1;
+    }
+
+    double period = std::atof(argv[1]);
+    int return_delay = std::atoi(argv[2]);
+    if (period <= 0.0 || return_delay < 0 || return_delay > 510) {
+        std::cerr << "Error: Period must be positive and return delay between 0 and 510 us" << std::endl;
+        return 1;
+    }
+
+    std::vector<int> counts;
+    for (int i = 3; i < argc; ++i) {
+        counts.push_back(std::atoi(argv[i]));
+    }
+    if (counts.empty()) {
+        counts = {6, 12, 24};
+    }
+
+    // Both groups go out as single packets, which bounds the servo count
+    size_t max_count = std::min(st3215::BusCostModel::maxSyncReadServos(),
+                                st3215::BusCostModel::maxSyncWriteServos(2));
+    for (int count : counts) {
+        if (count < 1 || static_cast<size_t>(count) > max_count) {
+            std::cerr << "Error: Servo count must be between 1 and " << max_count
+                      << " (one sync read and one sync write packet)" << std::endl;
+            return 1;
+        }
+    }
+
+    const uint32_t baudrates[] = {115200, 500000, 1000000};
+
+    std::cout << std::setw(8) << "baud" << std::setw(8) << "servos"
+              << std::setw(12) << "model ms" << std::setw(12) << "bus ms"
+              << std::setw(12) << "worst ms" << std::setw(11) << "occupancy"
+              << std::setw(10) << "feasible" << std::endl;
+
+    for (uint32_t baudrate : baudrates) {
+        for (int count : counts) {
+            std::vector<uint8_t> ids;
+            for (int id = 1; id <= count; ++id) {
+                ids.push_back(static_cast<uint8_t>(id));
+            }
+
+            st3215::BusCostModel model(baudrate);
+            model.setReturnDelay(static_cast<double>(return_delay));
+            double estimate = model.syncReadTime(ids, 2) + model.syncWriteTime(ids.size(), 2);
+
+            st3215::DryRun dry_run(baudrate);
+            for (uint8_t id : ids) {
+                dry_run.getPort()->addServo(id);
+                dry_run.getPort()->setRegister(id, st3215::STS_RETURN_DELAY_TIME, static_cast<uint8_t>(return_delay / 2));
+            }
+
+            st3215::ST3215& servo = dry_run.getServo();
+            st3215::GroupSyncRead sync_read(&servo, st3215::STS_PRESENT_POSITION_L, 2);
+            st3215::GroupSyncWrite sync_write(&servo, st3215::STS_GOAL_POSITION_L, 2);
+            for (uint8_t id : ids) {
+                sync_read.addParam(id);
+            }
+
+            auto report = dry_run.run(period, 200, [&](st3215::ST3215&, size_t cycle) {
+                int read_result = sync_read.txRxPacket();
+                uint16_t goal = static_cast<uint16_t>(2048 + (cycle % 100) * 10);
+                sync_write.clearParam();
+                for (uint8_t id : ids) {
+                    sync_write.addParam(id, {servo.lobyte(goal), servo.hibyte(goal)});
+                }
+                int write_result = sync_write.txPacket();
+                return (read_result != st3215::COMM_SUCCESS) ? read_result : write_result;
+            });
+
+            std::cout << std::setw(8) << baudrate << std::setw(8) << count << std::fixed << std::setprecision(3)
+                      << std::setw(12) << estimate << std::setw(12) << report.mean_bus_time
+                      << std::setw(12) << report.max_busy_time << std::setw(10) << std::setprecision(1)
+                      << report.occupancy * 100.0 << "%" << std::setw(10) << (report.feasible ? "yes" : "no")
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "st3215/clock.h"
+#include "st3215/protocol_engine.h"
+#include "st3215/simulated_port_handler.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <iomanip>
+
+// Drives one ProtocolEngine per bus from a single-threaded event loop,
+// without ProtocolPacketHandler: submit a request when a bus is idle, feed
+// whatever bytes have arrived, tick the engine, collect completions, and
+// sleep until the earliest reply deadline when nothing is readable. The two
+// simulated buses stand in for serial ports; a real loop would wait on their
+// file descriptors with poll() or epoll instead of sleeping.
+int main() {
+    st3215::VirtualClock clock;
+
+    struct Bus {
+        const char* name;
+        st3215::SimulatedPortHandler port;
+        st3215::ProtocolEngine engine;
+        std::array<uint8_t, 3> ids;
+        size_t next;  // Reads submitted
+        size_t done;  // Reads completed
+        std::vector<uint8_t> txpacket;
+        std::vector<uint8_t> output;
+        st3215::Transaction transaction;
+    };
+
+    std::array<Bus, 2> buses = {{
+        {"bus A", st3215::SimulatedPortHandler(&clock), {}, {1, 2, 3}, 0, 0, {}, {}, {}},
+        {"bus B", st3215::SimulatedPortHandler(&clock), {}, {4, 5, 6}, 0, 0, {}, {}, {}},
+    }};
+
+    for (Bus& bus : buses) {
+        bus.port.openPort();
+        bus.engine.setTxTimePerByte(bus.port.getTxTimePerByte());
+        for (uint8_t id : bus.ids) {
+            if (id != 6) {  // Servo 6 is missing, so its reads time out
+                bus.port.addServo(id, static_cast<uint16_t>(1000 + id * 100));
+            }
+        }
+    }
+
+    const size_t reads = 6;  // Per bus
+    std::vector<uint8_t> received;
+
+    while (buses[0].done < reads || buses[1].done < reads) {
+        bool progress = false;
+        double wake = clock.now() + 1.0;
+
+        for (Bus& bus : buses) {
+            // Start the next read when the bus is free
+            if (!bus.engine.isBusy() && bus.next < reads) {
+                uint8_t id = bus.ids[bus.next++ % bus.ids.size()];
+                bus.txpacket = st3215::ProtocolEngine::makePacket(id, st3215::INST_READ, {st3215::STS_PRESENT_POSITION_L, 2});
+                if (bus.engine.submit(bus.txpacket) == st3215::COMM_SUCCESS) {
+                    bus.port.clearPort();
+                    bus.engine.takeOutput(clock.now(), bus.output);
+                    bus.port.writePort(bus.output);
+                }
+            }
+
+            // Feed what has arrived, then let the engine check its deadline
+            size_t available = bus.port.getBytesAvailable();
+            if (available > 0) {
+                received = bus.port.readPort(available);
+                bus.engine.receive(received.data(), received.size(), clock.now());
+                progress = true;
+            }
+            bus.engine.tick(clock.now());
+
+            if (bus.engine.poll(bus.transaction)) {
+                ++bus.done;
+                progress = true;
+                std::cout << std::fixed << std::setprecision(3) << std::setw(9) << clock.now() << " ms  "
+                          << bus.name << "  servo " << static_cast<int>(bus.transaction.id) << "  ";
+                if (bus.transaction.result == st3215::COMM_SUCCESS) {
+                    const auto& rx = bus.transaction.rxpacket;
+                    int position = rx[st3215::PKT_PARAMETER0] | (rx[st3215::PKT_PARAMETER0 + 1] << 8);
+                    std::cout << "position " << position;
+                } else {
+                    std::cout << "result " << bus.transaction.result;
+                }
+                std::cout << "  (" << bus.transaction.latency << " ms)" << std::endl;
+            }
+
+            if (auto deadline = bus.engine.deadline()) {
+                wake = std::min(wake, *deadline);
+            }
+        }
+
+        // Nothing to do: sleep one byte time, or until the next deadline
+        if (!progress) {
+            clock.sleepUntil(std::min(wake, clock.now() + buses[0].port.getTxTimePerByte()));
+        }
+    }
+
+    return 0;
+}
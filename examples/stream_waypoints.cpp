@@ -0,0 +1,58 @@
+#include "st3215/st3215.h"
+#include "st3215/motion_queue.h"
+#include <iostream>
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <port> <servo_id> <position> [position...]" << std::endl;
+        std::cerr << "Example: " << argv[0] << " /dev/ttyUSB0 1 1024 2048 3072 2048" << std::endl;
+        return 1;
+    }
+
+    std::string port = argv[1];
+    int servo_id = std::atoi(argv[2]);
+
+    try {
+        st3215::ST3215 servo(port);
+
+        auto start = servo.readPosition(servo_id);
+        if (!start.has_value()) {
+            std::cerr << "Failed to read position of servo " << servo_id << std::endl;
+            return 1;
+        }
+
+        // Let the streamed setpoints define the motion profile
+        if (!servo.setMode(servo_id, 0) || !servo.setAcceleration(servo_id, 0)) {
+            std::cerr << "Failed to configure servo " << servo_id << std::endl;
+            return 1;
+        }
+
+        st3215::MotionQueue queue(&servo, 100.0);
+        queue.addServo(servo_id, start.value(), 2400.0, 5000.0);
+
+        for (int i = 3; i < argc; ++i) {
+            int position = std::atoi(argv[i]);
+            if (position < 0 || position > 4095) {
+                std::cerr << "Error: Position must be between 0 and 4095" << std::endl;
+                return 1;
+            }
+            queue.push(servo_id, position);
+        }
+
+        std::cout << "Streaming " << queue.pending(servo_id) << " waypoints to servo " << servo_id << "..."
+                  << std::endl;
+
+        int result = queue.run();
+        if (result != st3215::COMM_SUCCESS) {
+            std::cerr << servo.getTxRxResult(result) << std::endl;
+            return 1;
+        }
+
+        std::cout << "Done." << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
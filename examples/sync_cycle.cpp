@@ -0,0 +1,59 @@
+#include "st3215/dry_run.h"
+#include "st3215/sync_cycle.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+// Compares a fused sync write + sync read cycle with the same two packets
+// sent separately, against simulated servos in virtual time.
+int main(int argc, char** argv) {
+    int count = (argc > 1) ? std::atoi(argv[1]) : 6;
+    if (count < 1 || count > 253) {
+        std::cerr << "Usage: " << argv[0] << " [servo_count]" << std::endl;
+        std::cerr << "Error: Servo count must be between 1 and 253" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::setw(10) << "mode" << std::setw(14) << "writes/cycle"
+              << std::setw(12) << "cycle ms" << std::setw(10) << "failed"
+              << std::setw(12) << "position" << std::endl;
+
+    for (bool fused : {false, true}) {
+        st3215::DryRun dry_run;
+        for (int id = 1; id <= count; ++id) {
+            dry_run.getPort()->addServo(static_cast<uint8_t>(id));
+        }
+
+        st3215::ST3215& servo = dry_run.getServo();
+        st3215::GroupSyncWrite sync_write(&servo, st3215::STS_GOAL_POSITION_L, 2);
+        st3215::GroupSyncRead sync_read(&servo, st3215::STS_PRESENT_POSITION_L, 2);
+        for (int id = 1; id <= count; ++id) {
+            sync_read.addParam(static_cast<uint8_t>(id));
+        }
+
+        st3215::SyncCycle cycle(&servo, &sync_write, &sync_read);
+        cycle.setFused(fused);
+
+        const size_t cycles = 200;
+        dry_run.run(5.0, cycles, [&](st3215::ST3215&, size_t n) {
+            uint16_t goal = static_cast<uint16_t>(1024 + (n % 100) * 20);
+            sync_write.clearParam();
+            for (int id = 1; id <= count; ++id) {
+                sync_write.addParam(static_cast<uint8_t>(id), {servo.lobyte(goal), servo.hibyte(goal)});
+            }
+            return cycle.run();
+        });
+
+        auto [available, error] = sync_read.isAvailable(1, st3215::STS_PRESENT_POSITION_L, 2);
+        (void)error;
+        int position = available ? static_cast<int>(sync_read.getData(1, st3215::STS_PRESENT_POSITION_L, 2)) : -1;
+
+        const auto& stats = cycle.getStats();
+        std::cout << std::setw(10) << (fused ? "fused" : "separate") << std::fixed << std::setprecision(2)
+                  << std::setw(14) << static_cast<double>(dry_run.getPort()->getWriteCount()) / cycles
+                  << std::setprecision(3) << std::setw(12) << stats.mean_time
+                  << std::setw(10) << stats.failed << std::setw(12) << position << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#ifndef ST3215_BUS_COST_MODEL_H
+#define ST3215_BUS_COST_MODEL_H
+
+#include "protocol_packet_handler.h"
+#include "values.h"
+#include <map>
+#include <vector>
+#include <cstdint>
+
+namespace st3215 {
+
+/**
+ * @brief Estimates bus time of STS transactions
+ *
+ * Times are derived from the byte time at the configured baudrate (10 bits
+ * per byte, as PortHandler uses for timeouts), the instruction and status
+ * packet formats, and each servo's return delay. They are wire-time lower
+ * bounds: USB adapter latency and host scheduling come on top.
+ *
+ * Unicast instructions are charged for their status reply even when sent
+ * with a TxOnly method, since the servo still answers on the bus.
+ *
+ * Sync groups too large for one packet (TXPACKET_MAX_LEN) are charged as
+ * the packets they would be split into. GroupSyncWrite and GroupSyncRead
+ * do not split and fail with COMM_TX_ERROR instead; check the group size
+ * against maxSyncWriteServos() and maxSyncReadServos().
+ */
+class BusCostModel {
+public:
+    /**
+     * @brief Constructor
+     * @param baudrate Bus baudrate (default: 1000000)
+     */
+    explicit BusCostModel(uint32_t baudrate = DEFAULT_BAUDRATE);
+
+    /**
+     * @brief Set the bus baudrate
+     * @param baudrate Baudrate in bits per second
+     */
+    void setBaudRate(uint32_t baudrate);
+
+    /**
+     * @brief Get the time to transmit one byte
+     * @return Byte time in milliseconds
+     */
+    double getByteTime() const { return byte_time_; }
+
+    /**
+     * @brief Set the return delay of servos without an individual value
+     * @param usec Return delay in microseconds (default: 0)
+     */
+    void setReturnDelay(double usec) { default_return_delay_ = usec; }
+
+    /**
+     * @brief Set the return delay of one servo
+     * @param sts_id Servo ID
+     * @param usec Return delay in microseconds
+     */
+    void setReturnDelay(uint8_t sts_id, double usec) { return_delay_[sts_id] = usec; }
+
+    /**
+     * @brief Get the return delay of a servo
+     * @param sts_id Servo ID
+     * @return Return delay in microseconds
+     */
+    double getReturnDelay(uint8_t sts_id) const;
+
+    /**
+     * @brief Read the return delay register of servos
+     * @param ph Protocol packet handler
+     * @param ids Servo IDs
+     * @return COMM_SUCCESS, or the result of the first failed read
+     */
+    int loadReturnDelays(ProtocolPacketHandler* ph, const std::vector<uint8_t>& ids);
+
+    /**
+     * @brief Get the wire time of a number of bytes
+     * @param bytes Byte count
+     * @return Time in milliseconds
+     */
+    double packetTime(size_t bytes) const { return bytes * byte_time_; }
+
+    /**
+     * @brief Estimate a PING transaction
+     * @param sts_id Servo ID
+     * @return Time in milliseconds
+     */
+    double pingTime(uint8_t sts_id) const;
+
+    /**
+     * @brief Estimate a READ transaction
+     * @param sts_id Servo ID
+     * @param length Number of bytes read
+     * @return Time in milliseconds
+     */
+    double readTime(uint8_t sts_id, uint8_t length) const;
+
+    /**
+     * @brief Estimate a WRITE (or REG_WRITE) transaction
+     * @param sts_id Servo ID
+     * @param length Number of bytes written
+     * @return Time in milliseconds
+     */
+    double writeTime(uint8_t sts_id, uint8_t length) const;
+
+    /**
+     * @brief Estimate an ACTION instruction
+     * @param sts_id Servo ID (broadcast has no reply)
+     * @return Time in milliseconds
+     */
+    double actionTime(uint8_t sts_id = BROADCAST_ID) const;
+
+    /**
+     * @brief Get the most servos one SYNC_WRITE packet can address
+     * @param length Data length per servo
+     * @return Servo count
+     */
+    static size_t maxSyncWriteServos(uint8_t length) { return (TXPACKET_MAX_LEN - 8) / (1 + length); }
+
+    /**
+     * @brief Get the most servos one SYNC_READ packet can address
+     * @return Servo count
+     */
+    static size_t maxSyncReadServos() { return TXPACKET_MAX_LEN - 8; }
+
+    /**
+     * @brief Estimate a SYNC_WRITE instruction
+     * @param servo_count Number of servos (split above maxSyncWriteServos())
+     * @param length Data length per servo
+     * @return Time in milliseconds
+     */
+    double syncWriteTime(size_t servo_count, uint8_t length) const;
+
+    /**
+     * @brief Estimate a SYNC_READ transaction
+     * @param ids Servo IDs (replies are sent back to back; split above
+     *            maxSyncReadServos())
+     * @param length Data length per servo
+     * @return Time in milliseconds
+     */
+    double syncReadTime(const std::vector<uint8_t>& ids, uint8_t length) const;
+
+private:
+    double replyTime(uint8_t sts_id, uint8_t length) const;
+
+    double byte_time_;
+    double default_return_delay_;
+    std::map<uint8_t, double> return_delay_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_BUS_COST_MODEL_H
@@ -0,0 +1,92 @@
+#ifndef ST3215_CLOCK_H
+#define ST3215_CLOCK_H
+
+namespace st3215 {
+
+/**
+ * @brief Time source and sleep interface used throughout the library
+ *
+ * All times are monotonic and expressed in milliseconds. The default is the
+ * system clock; a VirtualClock can be injected into a PortHandler so that
+ * simulated runs execute as fast as the CPU allows.
+ */
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    /**
+     * @brief Get the current time
+     * @return Monotonic time in milliseconds
+     */
+    virtual double now() = 0;
+
+    /**
+     * @brief Block for a duration
+     * @param msec Duration in milliseconds (no-op if not positive)
+     */
+    virtual void sleepFor(double msec) = 0;
+
+    /**
+     * @brief Block until an absolute time
+     * @param msec Target time in milliseconds
+     */
+    virtual void sleepUntil(double msec);
+
+    /**
+     * @brief Busy-wait until an absolute time
+     *
+     * For the last fraction of a millisecond before a deadline, where a
+     * sleep would overshoot. The default simply calls sleepUntil().
+     *
+     * @param msec Target time in milliseconds
+     */
+    virtual void spinUntil(double msec);
+};
+
+/**
+ * @brief Clock backed by std::chrono::steady_clock
+ */
+class SystemClock : public Clock {
+public:
+    double now() override;
+    void sleepFor(double msec) override;
+    void spinUntil(double msec) override;
+
+    /**
+     * @brief Get the shared system clock instance
+     * @return Pointer to the process-wide system clock
+     */
+    static SystemClock* instance();
+};
+
+/**
+ * @brief Manually driven clock for simulation
+ *
+ * Time only moves when sleepFor(), sleepUntil() or advance() is called, so
+ * a sleep of any length returns immediately.
+ */
+class VirtualClock : public Clock {
+public:
+    /**
+     * @brief Constructor
+     * @param start_msec Initial time in milliseconds
+     */
+    explicit VirtualClock(double start_msec = 0.0) : now_(start_msec) {}
+
+    double now() override { return now_; }
+    void sleepFor(double msec) override;
+    void sleepUntil(double msec) override;
+
+    /**
+     * @brief Move time forward
+     * @param msec Duration in milliseconds (no-op if not positive)
+     */
+    void advance(double msec) { sleepFor(msec); }
+
+private:
+    double now_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_CLOCK_H
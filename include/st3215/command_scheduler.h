@@ -0,0 +1,172 @@
+#ifndef ST3215_COMMAND_SCHEDULER_H
+#define ST3215_COMMAND_SCHEDULER_H
+
+#include "protocol_packet_handler.h"
+#include "values.h"
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace st3215 {
+
+/**
+ * @brief Dispatch timing statistics of a CommandScheduler
+ *
+ * The dispatch error of a command is the time between its deadline and the
+ * moment its packet is handed to the port.
+ */
+struct DispatchStats {
+    uint64_t dispatched = 0;  ///< Commands sent
+    uint64_t failed = 0;      ///< Commands whose transaction did not succeed
+    double mean_error = 0.0;  ///< Mean dispatch error in milliseconds
+    double max_error = 0.0;   ///< Worst dispatch error in milliseconds
+};
+
+/**
+ * @brief Sends writes, sync writes and actions at absolute clock times
+ *
+ * Commands are kept ordered by deadline (ties in scheduling order) and sent
+ * by runUntil(), which sleeps on the port handler's clock until shortly
+ * before each deadline and busy-waits the remaining spin margin.
+ *
+ * Other traffic on the same bus should be gated with fits(), which reserves
+ * the bus ahead of the next deadline so a long read cannot delay it.
+ */
+class CommandScheduler {
+public:
+    /**
+     * @brief Constructor
+     * @param ph Protocol packet handler used to send commands
+     */
+    explicit CommandScheduler(ProtocolPacketHandler* ph);
+
+    /**
+     * @brief Schedule a register write (sent with a status reply)
+     * @param at_msec Deadline on the port handler's clock in milliseconds
+     * @param sts_id Servo ID
+     * @param address Register address
+     * @param data Bytes to write
+     * @return Command handle, or 0 if the command is invalid
+     */
+    uint64_t scheduleWrite(double at_msec, uint8_t sts_id, uint8_t address, const std::vector<uint8_t>& data);
+
+    /**
+     * @brief Schedule a sync write
+     * @param at_msec Deadline on the port handler's clock in milliseconds
+     * @param address Start register address
+     * @param length Data length per servo
+     * @param data Map of servo ID to data (each exactly length bytes)
+     * @return Command handle, or 0 if the command is invalid
+     */
+    uint64_t scheduleSyncWrite(double at_msec, uint8_t address, uint8_t length,
+                               const std::map<uint8_t, std::vector<uint8_t>>& data);
+
+    /**
+     * @brief Schedule an ACTION, releasing registered writes
+     * @param at_msec Deadline on the port handler's clock in milliseconds
+     * @param sts_id Servo ID (default: broadcast)
+     * @return Command handle
+     */
+    uint64_t scheduleAction(double at_msec, uint8_t sts_id = BROADCAST_ID);
+
+    /**
+     * @brief Cancel a pending command
+     * @param handle Command handle
+     * @return true if the command was pending
+     */
+    bool cancel(uint64_t handle);
+
+    /**
+     * @brief Cancel all pending commands
+     */
+    void clear() { commands_.clear(); }
+
+    /**
+     * @brief Get the number of pending commands
+     * @return Pending command count
+     */
+    size_t pending() const { return commands_.size(); }
+
+    /**
+     * @brief Get the deadline of the next pending command
+     * @return Deadline in milliseconds, or nullopt if none is pending
+     */
+    std::optional<double> nextDeadline() const;
+
+    /**
+     * @brief Check if a bus transaction can start now without delaying a command
+     * @param duration_msec Expected duration of the transaction
+     * @return true if it ends at least the guard time before the next deadline
+     */
+    bool fits(double duration_msec) const;
+
+    /**
+     * @brief Send every command whose deadline has passed, without waiting
+     * @return Number of commands sent
+     */
+    size_t dispatchDue();
+
+    /**
+     * @brief Send commands at their deadlines until a time is reached
+     * @param until_msec End time in milliseconds (the call returns then)
+     * @return Number of commands sent
+     */
+    size_t runUntil(double until_msec);
+
+    /**
+     * @brief Set the bus time reserved before each deadline by fits()
+     * @param msec Guard time in milliseconds (default: 0.5)
+     */
+    void setGuard(double msec) { guard_ = msec; }
+    double getGuard() const { return guard_; }
+
+    /**
+     * @brief Set how long before a deadline runUntil() stops sleeping and spins
+     * @param msec Spin margin in milliseconds (default: 1.0)
+     */
+    void setSpinMargin(double msec) { spin_margin_ = msec; }
+    double getSpinMargin() const { return spin_margin_; }
+
+    /**
+     * @brief Get dispatch timing statistics
+     * @return Statistics since construction or the last resetStats()
+     */
+    DispatchStats getStats() const;
+
+    /**
+     * @brief Reset dispatch timing statistics
+     */
+    void resetStats();
+
+private:
+    enum class Type { WRITE, SYNC_WRITE, ACTION };
+
+    struct Command {
+        Type type;
+        uint8_t sts_id;
+        uint8_t address;
+        uint8_t length;
+        std::vector<uint8_t> data;  // Write data, or sync write parameters
+    };
+
+    using Key = std::pair<double, uint64_t>;  // (deadline, handle)
+
+    uint64_t schedule(double at_msec, Command command);
+    void dispatch(const Key& key, const Command& command);
+
+    ProtocolPacketHandler* ph_;
+    std::map<Key, Command> commands_;
+    uint64_t next_handle_;
+    double guard_;
+    double spin_margin_;
+    uint64_t dispatched_;
+    uint64_t failed_;
+    double error_sum_;
+    double error_max_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_COMMAND_SCHEDULER_H
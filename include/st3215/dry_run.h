@@ -0,0 +1,93 @@
+#ifndef ST3215_DRY_RUN_H
+#define ST3215_DRY_RUN_H
+
+#include "st3215.h"
+#include "clock.h"
+#include "simulated_port_handler.h"
+#include "values.h"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+namespace st3215 {
+
+/**
+ * @brief Bus usage of one control cycle in a dry run
+ */
+struct CycleTiming {
+    double bus_time;   ///< Time the bus carried bytes or awaited a return delay (ms)
+    double busy_time;  ///< Time the cycle body took, including reply waits and timeouts (ms)
+};
+
+/**
+ * @brief Result of a dry run
+ */
+struct DryRunReport {
+    double period = 0.0;              ///< Loop period (ms)
+    std::vector<CycleTiming> cycles;  ///< Per-cycle timing
+    double mean_bus_time = 0.0;       ///< Mean bus time per cycle (ms)
+    double max_bus_time = 0.0;        ///< Worst bus time per cycle (ms)
+    double mean_busy_time = 0.0;      ///< Mean cycle body time (ms)
+    double max_busy_time = 0.0;       ///< Worst cycle body time (ms)
+    double occupancy = 0.0;           ///< Mean bus time divided by the period
+    size_t overruns = 0;              ///< Cycles whose body or bus time exceeded the period
+    size_t failures = 0;              ///< Cycles whose body returned an error
+    bool feasible = false;            ///< No cycle overran the period or failed
+    uint64_t tx_bytes = 0;            ///< Bytes sent over the whole run
+    uint64_t rx_bytes = 0;            ///< Bytes received over the whole run
+};
+
+/**
+ * @brief Runs a control loop against simulated servos in virtual time
+ *
+ * The loop body talks to a regular ST3215 whose port is a
+ * SimulatedPortHandler on a VirtualClock, so a run takes only the CPU time
+ * of the body and can be repeated for many configurations. Reply timing
+ * follows the baudrate and the servos' return delay registers.
+ */
+class DryRun {
+public:
+    /**
+     * @brief Constructor
+     * @param baudrate Simulated bus baudrate (default: 1000000)
+     */
+    explicit DryRun(uint32_t baudrate = DEFAULT_BAUDRATE);
+
+    /**
+     * @brief Get the simulated bus, e.g. to add servos before running
+     * @return Simulated port handler (owned by the servo object)
+     */
+    SimulatedPortHandler* getPort() { return port_; }
+
+    /**
+     * @brief Get the servo object the loop body uses
+     * @return ST3215 instance
+     */
+    ST3215& getServo() { return *servo_; }
+
+    /**
+     * @brief Get the virtual clock
+     * @return Virtual clock
+     */
+    VirtualClock& getClock() { return clock_; }
+
+    /**
+     * @brief Run a control loop
+     * @param period_msec Loop period in milliseconds
+     * @param cycles Number of cycles
+     * @param body Cycle body, called with the servo object and the cycle index;
+     *             returns COMM_SUCCESS or the first failed result of the cycle
+     * @return Timing report
+     */
+    DryRunReport run(double period_msec, size_t cycles, const std::function<int(ST3215&, size_t)>& body);
+
+private:
+    VirtualClock clock_;
+    SimulatedPortHandler* port_;
+    std::unique_ptr<ST3215> servo_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_DRY_RUN_H
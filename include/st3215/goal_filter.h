@@ -0,0 +1,137 @@
+#ifndef ST3215_GOAL_FILTER_H
+#define ST3215_GOAL_FILTER_H
+
+#include "protocol_packet_handler.h"
+#include "group_sync_write.h"
+#include "values.h"
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+namespace st3215 {
+
+/**
+ * @brief Batched goal position filter in front of a sync write
+ *
+ * Goals for all registered servos are kept in parallel arrays (one entry per
+ * servo) and filtered in a single pass: clamped to the servo angle limits,
+ * rate limited to a maximum step per cycle, and compared against the last
+ * sent goal with a deadband. Only servos whose goal changed by more than the
+ * deadband are included in the next sync write.
+ */
+class GoalFilter {
+public:
+    /**
+     * @brief Constructor
+     * @param ph Protocol packet handler used for limit reads and sync writes
+     */
+    explicit GoalFilter(ProtocolPacketHandler* ph);
+
+    /**
+     * @brief Add a servo to the filter
+     * @param sts_id Servo ID
+     * @param current_position Current servo position, used as slew reference
+     * @param min_limit Minimum allowed position (default: MIN_POSITION)
+     * @param max_limit Maximum allowed position (default: MAX_POSITION)
+     * @return true if added, false if already present
+     */
+    bool addServo(uint8_t sts_id, uint16_t current_position, uint16_t min_limit = MIN_POSITION,
+                  uint16_t max_limit = MAX_POSITION);
+
+    /**
+     * @brief Remove a servo from the filter
+     * @param sts_id Servo ID
+     */
+    void removeServo(uint8_t sts_id);
+
+    /**
+     * @brief Read STS_MIN_ANGLE_LIMIT / STS_MAX_ANGLE_LIMIT of all servos
+     *
+     * Limits are read with one sync read and cached. A servo reporting both
+     * limits as 0 (no limit configured) is clamped to MIN_POSITION-MAX_POSITION.
+     * If some replies are missing or corrupt, the servos that answered are
+     * still cached and the others keep their previous limits.
+     *
+     * @return Communication result (COMM_RX_CORRUPT or COMM_RX_TIMEOUT if
+     *         any servo's limits could not be read)
+     */
+    int loadLimits();
+
+    /**
+     * @brief Set the cached angle limits of a servo
+     * @param sts_id Servo ID
+     * @param min_limit Minimum allowed position
+     * @param max_limit Maximum allowed position (clamped to MAX_POSITION)
+     * @return true on success, false if the servo is unknown or min > max
+     */
+    bool setLimits(uint8_t sts_id, uint16_t min_limit, uint16_t max_limit);
+
+    /**
+     * @brief Set the maximum goal change per cycle
+     * @param sts_id Servo ID
+     * @param max_step Maximum step per apply() (0 disables slew limiting)
+     * @return true on success, false if the servo is unknown
+     */
+    bool setSlewLimit(uint8_t sts_id, uint16_t max_step);
+
+    /**
+     * @brief Set the deadband below which goal changes are not sent
+     * @param sts_id Servo ID
+     * @param deadband Deadband in steps (0 sends every change)
+     * @return true on success, false if the servo is unknown
+     */
+    bool setDeadband(uint8_t sts_id, uint16_t deadband);
+
+    /**
+     * @brief Set the requested goal position of a servo
+     * @param sts_id Servo ID
+     * @param position Requested goal (may be outside the limits)
+     * @return true on success, false if the servo is unknown
+     */
+    bool setGoal(uint8_t sts_id, int32_t position);
+
+    /**
+     * @brief Filter all goals
+     * @return Number of servos whose goal changed materially
+     */
+    size_t apply();
+
+    /**
+     * @brief Check if a servo's filtered goal will be sent
+     * @param sts_id Servo ID
+     * @return true if the last apply() marked the goal as changed
+     */
+    bool isChanged(uint8_t sts_id) const;
+
+    /**
+     * @brief Get the filtered goal of a servo
+     * @param sts_id Servo ID
+     * @return Filtered goal, or nullopt if the servo is unknown
+     */
+    std::optional<uint16_t> getFiltered(uint8_t sts_id) const;
+
+    /**
+     * @brief Send changed goals to STS_GOAL_POSITION_L in one sync write
+     * @return Communication result (COMM_SUCCESS if nothing changed)
+     */
+    int txPacket();
+
+private:
+    ProtocolPacketHandler* ph_;
+    GroupSyncWrite sync_write_;
+    std::map<uint8_t, size_t> index_;
+    std::vector<uint8_t> ids_;
+    std::vector<int32_t> goal_;
+    std::vector<int32_t> min_;
+    std::vector<int32_t> max_;
+    std::vector<int32_t> slew_;
+    std::vector<int32_t> deadband_;
+    std::vector<int32_t> last_;
+    std::vector<int32_t> out_;
+    std::vector<uint8_t> changed_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_GOAL_FILTER_H
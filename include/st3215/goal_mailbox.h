@@ -0,0 +1,104 @@
+#ifndef ST3215_GOAL_MAILBOX_H
+#define ST3215_GOAL_MAILBOX_H
+
+#include "protocol_packet_handler.h"
+#include "group_sync_write.h"
+#include "values.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace st3215 {
+
+/**
+ * @brief Latest-value goal mailboxes, one per servo ID
+ *
+ * A planner thread posts goals with post(); a bus thread calls txPacket()
+ * once per cycle, which sends only the newest goal of every servo that
+ * received one since the previous cycle. Goals overwritten before they were
+ * sent are counted as conflated, including a goal whose write failed after a
+ * newer one was posted. Every posted goal ends up delivered, conflated or
+ * still pending.
+ *
+ * Each mailbox must have a single writer thread. post() and txPacket() are
+ * wait-free: one atomic exchange per post and one atomic read-modify-write
+ * per delivered goal, no locks.
+ */
+class GoalMailbox {
+public:
+    /**
+     * @brief Constructor
+     * @param ph Protocol packet handler used by the bus thread
+     */
+    explicit GoalMailbox(ProtocolPacketHandler* ph);
+
+    /**
+     * @brief Post a new goal, replacing any goal not yet sent (writer side)
+     * @param sts_id Servo ID (0-253)
+     * @param position Goal position (0-4095)
+     * @param speed Goal speed (default: 0, servo maximum)
+     * @return true if posted, false if the ID is invalid or position exceeds
+     *         MAX_POSITION (nothing is posted or counted)
+     */
+    bool post(uint8_t sts_id, uint16_t position, uint16_t speed = 0);
+
+    /**
+     * @brief Send the newest pending goals in one sync write (bus side)
+     *
+     * Goals are written to STS_GOAL_POSITION_L as [POS_L, POS_H, TIME_L,
+     * TIME_H, SPEED_L, SPEED_H]. If the write fails, goals that were not
+     * overwritten in the meantime stay pending for the next cycle; goals
+     * that were are counted as conflated.
+     *
+     * @return Communication result (COMM_SUCCESS if nothing was pending)
+     */
+    int txPacket();
+
+    /**
+     * @brief Get the number of goals posted for a servo
+     * @param sts_id Servo ID
+     * @return Posted goal count
+     */
+    uint64_t getPosted(uint8_t sts_id) const;
+
+    /**
+     * @brief Get the number of goals for a servo that were replaced unsent
+     * @param sts_id Servo ID
+     * @return Conflated goal count
+     */
+    uint64_t getConflated(uint8_t sts_id) const;
+
+    /**
+     * @brief Get the number of goals for a servo that were sent
+     * @param sts_id Servo ID
+     * @return Delivered goal count
+     */
+    uint64_t getDelivered(uint8_t sts_id) const;
+
+    /**
+     * @brief Get the total number of conflated goals over all servos
+     * @return Conflated goal count
+     */
+    uint64_t getTotalConflated() const;
+
+private:
+    // Slot word: bit 32 = pending flag, bits 16-31 = speed, bits 0-15 = position
+    static constexpr uint64_t PENDING = uint64_t{1} << 32;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> word{0};
+        std::atomic<uint64_t> posted{0};      // Written by the writer thread only
+        std::atomic<uint64_t> conflated{0};   // Written by the writer thread only
+        std::atomic<uint64_t> delivered{0};   // Written by the bus thread only
+        std::atomic<uint64_t> superseded{0};  // Failed writes replaced before re-arm, bus thread only
+    };
+
+    ProtocolPacketHandler* ph_;
+    GroupSyncWrite sync_write_;
+    std::array<Slot, BROADCAST_ID> slots_;
+    std::array<uint64_t, BROADCAST_ID> taken_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_GOAL_MAILBOX_H
@@ -2,8 +2,8 @@
 #define ST3215_GROUP_SYNC_READ_H
 
 #include "protocol_packet_handler.h"
+#include "sync_read_scanner.h"
 #include "values.h"
-#include <map>
 #include <vector>
 #include <cstdint>
 #include <tuple>
@@ -14,7 +14,10 @@ namespace st3215 {
  * @brief Handles synchronized read operations from multiple servos
  *
  * This class enables reading the same type of data from multiple servos
- * efficiently using sync read packets.
+ * efficiently using sync read packets. Servo IDs and their [ERROR, DATA...]
+ * slots are kept in flat buffers in ID order, sized when servos are added,
+ * and the reply buffer is reused, so reading a group every cycle does not
+ * allocate.
  */
 class GroupSyncRead {
 public:
@@ -27,7 +30,10 @@ public:
     GroupSyncRead(ProtocolPacketHandler* ph, uint8_t start_address, uint8_t data_length);
 
     /**
-     * @brief Build the parameter list from stored servo IDs
+     * @brief Prepare the reply layout for the current servo IDs
+     *
+     * IDs are stored in packet order, so this only updates the reply
+     * scanner; txPacket() calls it when the group changed.
      */
     void makeParam();
 
@@ -95,13 +101,33 @@ public:
     uint32_t getData(uint8_t sts_id, uint8_t address, uint8_t data_length);
 
 private:
+    /**
+     * @brief Find the slot of a servo
+     * @param sts_id Servo ID
+     * @return Slot index, or the number of servos if the ID is not in the group
+     */
+    size_t findSlot(uint8_t sts_id) const;
+
+    /**
+     * @brief Search a reply for one servo's status frame
+     * @param rxpacket Raw received packet data
+     * @param sts_id Servo ID
+     * @param data_length Expected data length
+     * @param slot Receives [ERROR, DATA...] (data_length + 1 bytes)
+     * @return Communication result
+     */
+    int findFrame(const std::vector<uint8_t>& rxpacket, uint8_t sts_id, uint8_t data_length, uint8_t* slot) const;
+
     ProtocolPacketHandler* ph_;
     uint8_t start_address_;
     uint8_t data_length_;
     bool last_result_;
     bool is_param_changed_;
-    std::vector<uint8_t> param_;
-    std::map<uint8_t, std::vector<uint8_t>> data_dict_;
+    std::vector<uint8_t> param_;     // Servo IDs in ID (and request) order
+    std::vector<uint8_t> data_;      // [ERROR, DATA...] per servo, same order
+    std::vector<uint8_t> valid_;     // Slot holds data from the last reply
+    std::vector<uint8_t> rxpacket_;  // Reused reply buffer
+    SyncReadScanner scanner_;        // Fast path for replies in request order
 };
 
 }  // namespace st3215
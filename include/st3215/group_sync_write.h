@@ -3,7 +3,6 @@
 
 #include "protocol_packet_handler.h"
 #include "values.h"
-#include <map>
 #include <vector>
 #include <cstdint>
 
@@ -13,7 +12,9 @@ namespace st3215 {
  * @brief Handles synchronized write operations to multiple servos
  *
  * This class enables writing the same type of data to multiple servos
- * in a single packet, improving communication efficiency.
+ * in a single packet, improving communication efficiency. Records are kept
+ * in packet order (sorted by ID) in one buffer sized for the largest
+ * packet, so refilling a group every cycle does not allocate.
  */
 class GroupSyncWrite {
 public:
@@ -27,13 +28,16 @@ public:
 
     /**
      * @brief Build the parameter list from stored data
+     *
+     * Records are stored in packet order, so this has nothing left to do;
+     * it is kept for API compatibility.
      */
     void makeParam();
 
     /**
      * @brief Add a servo and its data to the sync write group
      * @param sts_id Servo ID
-     * @param data Data to write
+     * @param data Data to write (zero-padded to the data length)
      * @return true if added successfully, false if ID already exists or data too long
      */
     bool addParam(uint8_t sts_id, const std::vector<uint8_t>& data);
@@ -63,13 +67,24 @@ public:
      */
     int txPacket();
 
+    /**
+     * @brief Stage the sync write packet to go out with the next transmitted packet
+     * @return Communication result (COMM_NOT_AVAILABLE if the group is empty)
+     */
+    int stagePacket();
+
 private:
+    /**
+     * @brief Find the record of a servo, or where it would be inserted
+     * @param sts_id Servo ID
+     * @return Offset into param_
+     */
+    size_t lowerBound(uint8_t sts_id) const;
+
     ProtocolPacketHandler* ph_;
     uint8_t start_address_;
     uint8_t data_length_;
-    bool is_param_changed_;
-    std::vector<uint8_t> param_;
-    std::map<uint8_t, std::vector<uint8_t>> data_dict_;
+    std::vector<uint8_t> param_;  // ID DATA... records sorted by ID
 };
 
 }  // namespace st3215
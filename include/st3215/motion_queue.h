@@ -0,0 +1,165 @@
+#ifndef ST3215_MOTION_QUEUE_H
+#define ST3215_MOTION_QUEUE_H
+
+#include "protocol_packet_handler.h"
+#include "group_sync_write.h"
+#include "values.h"
+#include <map>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+namespace st3215 {
+
+/**
+ * @brief Streams blended waypoint motion to one or more servos
+ *
+ * Each servo owns a queue of target positions. Queued targets are planned
+ * with look-ahead: consecutive moves in the same direction pass through the
+ * intermediate waypoint without stopping, while the speed is kept low enough
+ * that the servo can still come to rest at the last queued target. The
+ * resulting position setpoints are sampled at a fixed rate and sent to all
+ * servos in a single sync write per cycle.
+ *
+ * Time is taken from the clock of the packet handler's port, so a queue
+ * driving a simulated bus with a VirtualClock runs faster than real time.
+ *
+ * Setpoints are written to STS_GOAL_POSITION_L as [POS_L, POS_H, TIME_L,
+ * TIME_H, SPEED_L, SPEED_H] with the planned speed, so the servo acceleration
+ * register should be left at 0 (no internal ramp) while streaming. A goal
+ * speed of 0 means "no limit" to the servo, so setpoints whose planned speed
+ * rounds to 0 (the final one in particular) carry the axis speed limit.
+ *
+ * Each axis is planned on its own: servos given a waypoint together start
+ * together but arrive at different times when their distances or limits
+ * differ. Use ST3215::syncMoveInTime() for moves that must arrive together.
+ */
+class MotionQueue {
+public:
+    /**
+     * @brief Constructor
+     * @param ph Protocol packet handler used for the sync writes
+     * @param rate_hz Setpoint streaming rate (default: 100 Hz)
+     */
+    explicit MotionQueue(ProtocolPacketHandler* ph, double rate_hz = 100.0);
+
+    /**
+     * @brief Add a servo to the queue
+     * @param sts_id Servo ID
+     * @param start_position Current servo position (0-4095)
+     * @param max_speed Speed limit (default: 2400 step/s)
+     * @param max_acc Acceleration limit (default: 5000 step/s²)
+     * @return true if added, false if already present or limits are invalid
+     */
+    bool addServo(uint8_t sts_id, uint16_t start_position, double max_speed = 2400.0, double max_acc = 5000.0);
+
+    /**
+     * @brief Remove a servo and drop its pending waypoints
+     * @param sts_id Servo ID
+     */
+    void removeServo(uint8_t sts_id);
+
+    /**
+     * @brief Append a waypoint for one servo
+     * @param sts_id Servo ID
+     * @param position Target position (0-4095)
+     * @return true if queued, false if the servo is unknown
+     */
+    bool push(uint8_t sts_id, uint16_t position);
+
+    /**
+     * @brief Append a waypoint for several servos at once
+     *
+     * Equivalent to push() per servo: each axis is planned with its own
+     * limits, so arrival times are not synchronized.
+     *
+     * @param waypoint Map of servo ID to target position
+     * @return true if queued for every servo, false if any servo is unknown
+     */
+    bool push(const std::map<uint8_t, uint16_t>& waypoint);
+
+    /**
+     * @brief Drop all pending waypoints, bringing every servo to rest
+     *
+     * Servos that are moving decelerate at their acceleration limit.
+     */
+    void clear();
+
+    /**
+     * @brief Check if all queues are empty and the final setpoints were sent
+     * @return true if there is nothing left to stream
+     */
+    bool isIdle() const;
+
+    /**
+     * @brief Get the number of queued waypoints for a servo
+     * @param sts_id Servo ID
+     * @return Number of waypoints not yet reached
+     */
+    size_t pending(uint8_t sts_id) const;
+
+    /**
+     * @brief Get the last setpoint sampled for a servo
+     * @param sts_id Servo ID
+     * @return Setpoint position, or nullopt if the servo is unknown
+     */
+    std::optional<double> getSetpoint(uint8_t sts_id) const;
+
+    /**
+     * @brief Sample all servos at the current time and send one sync write
+     * @return Communication result (COMM_SUCCESS if nothing had to be sent)
+     */
+    int tick();
+
+    /**
+     * @brief Call tick() at the configured rate until the queue is idle
+     * @return Communication result of the first failing tick, or COMM_SUCCESS
+     */
+    int run();
+
+    /**
+     * @brief Get the streaming rate
+     * @return Rate in Hz
+     */
+    double getRate() const { return 1.0 / period_; }
+
+private:
+    struct Segment {
+        double start;       // Start position (steps)
+        double target;      // Target position (steps)
+        double v_entry;     // Speed at start (step/s, along direction)
+        double v_exit;      // Speed at target (step/s, along direction)
+        double v_cruise;    // Peak speed (step/s)
+        double dec;         // Deceleration used in the last phase (step/s²)
+        double t_acc;       // Duration of each phase (s)
+        double t_cruise;
+        double t_dec;
+        double t_start;     // Time the segment became active, < 0 if not yet
+    };
+
+    struct Axis {
+        double max_speed;
+        double max_acc;
+        double setpoint;
+        double velocity;
+        bool needs_send;
+        std::deque<Segment> segments;
+    };
+
+    double now() const;
+    void replan(Axis& axis, double t);
+    void profile(const Axis& axis, Segment& seg) const;
+    void sample(const Segment& seg, double t, double& position, double& velocity) const;
+    void advance(Axis& axis, double t);
+
+    ProtocolPacketHandler* ph_;
+    double period_;
+    GroupSyncWrite sync_write_;
+    std::map<uint8_t, Axis> axes_;
+    std::vector<uint8_t> record_;  // Reused [POS, TIME, SPEED] record for tick()
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_MOTION_QUEUE_H
@@ -1,6 +1,7 @@
 #ifndef ST3215_PORT_HANDLER_H
 #define ST3215_PORT_HANDLER_H
 
+#include "clock.h"
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -12,7 +13,8 @@ namespace st3215 {
  * @brief Handles serial port communication for ST3215 servos
  * 
  * This class provides low-level serial communication with ST3215 servo motors.
- * It manages the serial port, timing, and buffering.
+ * It manages the serial port, timing, and buffering. The port I/O methods are
+ * virtual so that a simulated bus can stand in for the serial device.
  */
 class PortHandler {
 public:
@@ -25,7 +27,7 @@ public:
     /**
      * @brief Destructor - closes the port if open
      */
-    ~PortHandler();
+    virtual ~PortHandler();
 
     // Disable copy and move to prevent port conflicts
     PortHandler(const PortHandler&) = delete;
@@ -37,17 +39,17 @@ public:
      * @brief Open the serial port
      * @return true if successful, false otherwise
      */
-    bool openPort();
+    virtual bool openPort();
 
     /**
      * @brief Close the serial port
      */
-    void closePort();
+    virtual void closePort();
 
     /**
      * @brief Clear the port buffers
      */
-    void clearPort();
+    virtual void clearPort();
 
     /**
      * @brief Set the port name
@@ -72,27 +74,27 @@ public:
      * @param baudrate New baudrate value
      * @return true if successful, false otherwise
      */
-    bool setBaudRate(uint32_t baudrate);
+    virtual bool setBaudRate(uint32_t baudrate);
 
     /**
      * @brief Get number of bytes available to read
      * @return Number of available bytes
      */
-    size_t getBytesAvailable();
+    virtual size_t getBytesAvailable();
 
     /**
      * @brief Read data from the port
      * @param length Number of bytes to read
      * @return Vector containing read bytes
      */
-    std::vector<uint8_t> readPort(size_t length);
+    virtual std::vector<uint8_t> readPort(size_t length);
 
     /**
      * @brief Write data to the port
      * @param packet Data to write
      * @return Number of bytes written
      */
-    size_t writePort(const std::vector<uint8_t>& packet);
+    virtual size_t writePort(const std::vector<uint8_t>& packet);
 
     /**
      * @brief Set timeout for packet reception
@@ -114,10 +116,28 @@ public:
 
     /**
      * @brief Get current time in milliseconds
-     * @return Current time
+     * @return Current time from the port clock
      */
     double getCurrentTime();
 
+    /**
+     * @brief Set the clock used for timeouts and sleeps
+     * @param clock Clock to use, or nullptr for the system clock (not owned)
+     */
+    void setClock(Clock* clock);
+
+    /**
+     * @brief Get the clock used for timeouts and sleeps
+     * @return Current clock
+     */
+    Clock* getClock() const { return clock_; }
+
+    /**
+     * @brief Get the transmission time of one byte at the current baudrate
+     * @return Time per byte in milliseconds (0 until the port is opened)
+     */
+    double getTxTimePerByte() const { return tx_time_per_byte_; }
+
     /**
      * @brief Get time elapsed since packet start
      * @return Elapsed time in milliseconds
@@ -142,9 +162,7 @@ public:
      */
     void setUsing(bool using_flag) { is_using_ = using_flag; }
 
-private:
-    bool setupPort();
-
+protected:
     bool is_open_;
     uint32_t baudrate_;
     double packet_start_time_;
@@ -152,6 +170,11 @@ private:
     double tx_time_per_byte_;
     bool is_using_;
     std::string port_name_;
+    Clock* clock_;
+
+private:
+    bool setupPort();
+
     int serial_fd_;  // File descriptor for serial port
 };
 
@@ -0,0 +1,183 @@
+#ifndef ST3215_PROTOCOL_ENGINE_H
+#define ST3215_PROTOCOL_ENGINE_H
+
+#include "values.h"
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+namespace st3215 {
+
+/**
+ * @brief Result of a completed transaction
+ */
+struct Transaction {
+    uint8_t id;                     ///< ID of the instruction packet
+    uint8_t instruction;            ///< Instruction code
+    int result;                     ///< Communication result (COMM_*)
+    uint8_t error;                  ///< Servo error byte of the status packet
+    std::vector<uint8_t> rxpacket;  ///< Status packet, or raw sync read reply bytes
+    double latency;                 ///< Time from send to completion in milliseconds
+};
+
+/**
+ * @brief Sans-I/O STS protocol state machine
+ *
+ * The engine performs no I/O and never reads a clock. The caller submits an
+ * instruction packet, writes the bytes returned by takeOutput() to the bus,
+ * feeds received bytes with receive() and the current time with tick(), and
+ * collects the result with poll(). deadline() tells an event loop when the
+ * next tick() is needed. One transaction is in flight at a time.
+ *
+ * ProtocolPacketHandler drives an engine with blocking PortHandler I/O; an
+ * external reactor can drive one engine per bus from a single thread.
+ */
+class ProtocolEngine {
+public:
+    ProtocolEngine();
+
+    /**
+     * @brief Build an instruction packet
+     * @param sts_id Servo ID (or BROADCAST_ID)
+     * @param instruction Instruction code
+     * @param params Parameter bytes
+     * @return Packet with header and checksum left to be filled by submit()
+     */
+    static std::vector<uint8_t> makePacket(uint8_t sts_id, uint8_t instruction, const std::vector<uint8_t>& params);
+
+    /**
+     * @brief Set the transmission time of one byte, used for reply deadlines
+     * @param msec Time per byte in milliseconds
+     */
+    void setTxTimePerByte(double msec) { tx_time_per_byte_ = msec; }
+
+    /**
+     * @brief Start a transaction
+     *
+     * Fills in the packet header and checksum. A reply is awaited if
+     * expect_reply is set and the packet is addressed to one servo, or if it
+     * is a sync read; otherwise the transaction completes once sent.
+     *
+     * @param txpacket Instruction packet (modified in place)
+     * @param expect_reply Wait for a status packet
+     * @return COMM_SUCCESS, COMM_PORT_BUSY if a transaction is in flight or
+     *         not yet polled, or COMM_TX_ERROR if the packet is malformed
+     */
+    int submit(std::vector<uint8_t>& txpacket, bool expect_reply = true);
+
+    /**
+     * @brief Queue a broadcast packet to go out ahead of the next submit()
+     *
+     * Staged packets are prepended to the output of the next submitted
+     * packet, so for example a sync write and a sync read request reach the
+     * bus in one port write. The reply deadline includes their bytes.
+     *
+     * @param txpacket Broadcast instruction packet (modified in place)
+     * @return COMM_SUCCESS, COMM_PORT_BUSY if a transaction is in flight, or
+     *         COMM_TX_ERROR if the packet is malformed or not a broadcast
+     */
+    int stage(std::vector<uint8_t>& txpacket);
+
+    /**
+     * @brief Drop packets staged since the last submit()
+     */
+    void clearStaged() { staged_.clear(); }
+
+    /**
+     * @brief Take the bytes to write to the bus and arm the reply deadline
+     * @param now Current time in milliseconds
+     * @return Bytes to send (empty if nothing is pending)
+     */
+    std::vector<uint8_t> takeOutput(double now);
+
+    /**
+     * @brief Take the bytes to write by swapping them into a caller buffer
+     *
+     * Swapping hands the caller's old buffer back to the engine, so a caller
+     * that keeps its buffer sends packets without allocating.
+     *
+     * @param now Current time in milliseconds
+     * @param output Receives the bytes to send (cleared if nothing is pending)
+     */
+    void takeOutput(double now, std::vector<uint8_t>& output);
+
+    /**
+     * @brief Feed bytes received from the bus
+     * @param data Received bytes
+     * @param length Number of bytes
+     * @param now Current time in milliseconds
+     */
+    void receive(const uint8_t* data, size_t length, double now);
+
+    /**
+     * @brief Advance time, completing the transaction on timeout
+     * @param now Current time in milliseconds
+     */
+    void tick(double now);
+
+    /**
+     * @brief Get the time at which tick() must be called next
+     * @return Deadline in milliseconds, or nullopt if no reply is awaited
+     */
+    std::optional<double> deadline() const;
+
+    /**
+     * @brief Get how many more bytes are needed for the current frame
+     * @return Byte count (0 if no reply is awaited)
+     */
+    size_t bytesWanted() const;
+
+    /**
+     * @brief Collect the completed transaction, freeing the engine
+     * @return Completed transaction, or nullopt if still in flight or idle
+     */
+    std::optional<Transaction> poll();
+
+    /**
+     * @brief Collect the completed transaction by swapping it into a caller object
+     *
+     * Like takeOutput(double, std::vector<uint8_t>&), the caller's old
+     * rxpacket buffer is reused for the next reply.
+     *
+     * @param transaction Receives the completed transaction
+     * @return true if a transaction was collected
+     */
+    bool poll(Transaction& transaction);
+
+    /**
+     * @brief Check if a transaction is in flight or waiting to be polled
+     * @return true if busy
+     */
+    bool isBusy() const { return state_ != State::IDLE; }
+
+    /**
+     * @brief Abandon the current transaction and any staged packets
+     */
+    void cancel();
+
+private:
+    enum class State { IDLE, SENDING, AWAIT_STATUS, AWAIT_SYNC_READ, DONE };
+
+    size_t finalize(std::vector<uint8_t>& txpacket) const;
+    void parseStatus(double now);
+    void complete(int result, double now);
+
+    State state_;
+    bool expect_reply_;
+    uint8_t tx_id_;
+    uint8_t tx_instruction_;
+    size_t reply_length_;   // Reply size used for the timeout
+    size_t wait_length_;    // Bytes needed for the current frame (or whole sync reply)
+    size_t staged_length_;  // Staged bytes sent ahead of the current packet
+    double tx_time_per_byte_;
+    double sent_time_;
+    double timeout_;
+    std::vector<uint8_t> output_;
+    std::vector<uint8_t> staged_;
+    std::vector<uint8_t> rx_buffer_;
+    Transaction completion_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_PROTOCOL_ENGINE_H
@@ -2,6 +2,7 @@
 #define ST3215_PROTOCOL_PACKET_HANDLER_H
 
 #include "port_handler.h"
+#include "protocol_engine.h"
 #include "values.h"
 #include <vector>
 #include <string>
@@ -24,6 +25,12 @@ public:
      */
     explicit ProtocolPacketHandler(PortHandler* port_handler);
 
+    /**
+     * @brief Get the port handler used for I/O
+     * @return Port handler pointer
+     */
+    PortHandler* getPortHandler() const { return port_handler_; }
+
     /**
      * @brief Get protocol version
      * @return Protocol version (1.0)
@@ -166,8 +173,42 @@ public:
 
     int syncReadTx(uint8_t start_address, uint8_t data_length, const std::vector<uint8_t>& param, size_t param_length);
     std::tuple<int, std::vector<uint8_t>> syncReadRx(uint8_t data_length, size_t param_length);
+
+    /**
+     * @brief Receive a sync read reply into a reused buffer
+     *
+     * The reply is swapped into rxpacket and the caller's previous buffer is
+     * handed back to the handler, so a group that keeps one buffer reads
+     * without allocating.
+     *
+     * @param data_length Data length per servo
+     * @param param_length Number of servos read
+     * @param rxpacket Receives the raw replies
+     * @return Communication result (COMM_RX_CORRUPT if the reply length is wrong)
+     */
+    int syncReadRx(uint8_t data_length, size_t param_length, std::vector<uint8_t>& rxpacket);
     int syncWriteTxOnly(uint8_t start_address, uint8_t data_length, const std::vector<uint8_t>& param, size_t param_length);
 
+    /**
+     * @brief Stage a sync write to go out with the next transmitted packet
+     *
+     * The sync write is sent in the same port write as the next packet, so a
+     * write-then-read cycle costs one bus turnaround and clearPort() cannot
+     * discard the write before it leaves the adapter.
+     *
+     * @param start_address Start address
+     * @param data_length Data length per servo
+     * @param param Parameters (ID + data for each servo)
+     * @param param_length Parameter length
+     * @return Communication result
+     */
+    int syncWriteStage(uint8_t start_address, uint8_t data_length, const std::vector<uint8_t>& param, size_t param_length);
+
+    /**
+     * @brief Drop packets staged with syncWriteStage() without sending them
+     */
+    void clearStaged() { engine_.clearStaged(); }
+
     // Helper functions for byte manipulation
     uint16_t makeWord(uint8_t a, uint8_t b) const;
     uint32_t makeDWord(uint16_t a, uint16_t b) const;
@@ -184,12 +225,17 @@ protected:
     /**
      * @brief Transmit a packet
      * @param txpacket Packet to transmit
+     * @param expect_reply Arm the engine to wait for the status packet
      * @return Communication result
      */
-    int txPacket(std::vector<uint8_t>& txpacket);
+    int txPacket(std::vector<uint8_t>& txpacket, bool expect_reply = true);
 
     /**
-     * @brief Receive a packet
+     * @brief Receive the reply to the last transmitted packet
+     *
+     * Blocks on the port, feeding the protocol engine until the reply is
+     * complete or times out.
+     *
      * @return Tuple of (rxpacket, result)
      */
     std::tuple<std::vector<uint8_t>, int> rxPacket();
@@ -201,8 +247,66 @@ protected:
      */
     std::tuple<std::vector<uint8_t>, int, uint8_t> txRxPacket(std::vector<uint8_t>& txpacket);
 
+    /**
+     * @brief Wait for the reply to the last transmitted packet
+     *
+     * The reply is left in transaction_ and the port is released.
+     *
+     * @return Communication result
+     */
+    int waitReply();
+
+    /**
+     * @brief Start an instruction packet in the reusable transmit buffer
+     * @param sts_id Servo ID
+     * @param instruction Instruction code
+     * @param param_length Number of parameter bytes
+     * @return Pointer to the (zeroed) parameter bytes; a packet longer than
+     *         TXPACKET_MAX_LEN is rejected with COMM_TX_ERROR when sent
+     */
+    uint8_t* preparePacket(uint8_t sts_id, uint8_t instruction, size_t param_length);
+
+    /**
+     * @brief Transmit the prepared packet and wait for its reply if any
+     * @param expect_reply Wait for the status packet (ignored for broadcast)
+     * @return Communication result
+     */
+    int transact(bool expect_reply);
+
+    /**
+     * @brief Read registers into a caller buffer without allocating
+     * @param sts_id Servo ID
+     * @param address Start address
+     * @param length Number of bytes to read
+     * @param data Output buffer of at least length bytes
+     * @param error Servo error byte
+     * @return Communication result (COMM_RX_CORRUPT if the reply is short)
+     */
+    int readRegisters(uint8_t sts_id, uint8_t address, uint8_t length, uint8_t* data, uint8_t& error);
+
+    /**
+     * @brief Send a WRITE or REG_WRITE packet without allocating
+     * @param sts_id Servo ID
+     * @param instruction INST_WRITE or INST_REG_WRITE
+     * @param address Start address
+     * @param length Number of register bytes
+     * @param data Data to write
+     * @param data_size Bytes available in data (zero-padded to length)
+     * @param expect_reply Wait for the status packet
+     * @param error Servo error byte
+     * @return Communication result
+     */
+    int writeRegisters(uint8_t sts_id, uint8_t instruction, uint8_t address, uint8_t length,
+                       const uint8_t* data, size_t data_size, bool expect_reply, uint8_t& error);
+
     PortHandler* port_handler_;
+    ProtocolEngine engine_;  // Framing, reply matching and deadlines
     uint8_t sts_end_;  // Endianness (0 for little-endian)
+
+    // Buffers swapped with the engine and reused for every packet
+    std::vector<uint8_t> tx_buffer_;
+    std::vector<uint8_t> output_;
+    Transaction transaction_;
 };
 
 }  // namespace st3215
@@ -0,0 +1,144 @@
+#ifndef ST3215_SIMULATED_PORT_HANDLER_H
+#define ST3215_SIMULATED_PORT_HANDLER_H
+
+#include "port_handler.h"
+#include "values.h"
+#include <array>
+#include <deque>
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+namespace st3215 {
+
+/**
+ * @brief In-process simulated servo bus
+ *
+ * Replaces the serial device with a set of simulated servos that answer
+ * ping, read, write, reg write/action, sync write and sync read packets from
+ * a register table. Reply bytes become readable at the time they would have
+ * arrived on a real bus (request and reply transmission at the configured
+ * baudrate plus each servo's return delay), measured on the port clock.
+ *
+ * Motion is modelled kinematically: in position mode the present position
+ * moves toward the goal at the goal speed (or derived from the goal time),
+ * in wheel mode it moves at the goal speed until it reaches a mechanical stop.
+ *
+ * With a VirtualClock, reads that find no data advance the clock to the next
+ * byte arrival (or by one byte time), so programs run faster than real time.
+ */
+class SimulatedPortHandler : public PortHandler {
+public:
+    /**
+     * @brief Constructor
+     * @param clock Clock to use, or nullptr for the system clock (not owned)
+     */
+    explicit SimulatedPortHandler(Clock* clock = nullptr);
+
+    bool openPort() override;
+    void closePort() override;
+    void clearPort() override;
+    bool setBaudRate(uint32_t baudrate) override;
+    size_t getBytesAvailable() override;
+    std::vector<uint8_t> readPort(size_t length) override;
+    size_t writePort(const std::vector<uint8_t>& packet) override;
+
+    /**
+     * @brief Add a simulated servo
+     * @param sts_id Servo ID (0-253)
+     * @param position Initial position (0-4095)
+     * @return true if added, false if the ID is invalid or already present
+     */
+    bool addServo(uint8_t sts_id, uint16_t position = 2048);
+
+    /**
+     * @brief Remove a simulated servo
+     * @param sts_id Servo ID
+     */
+    void removeServo(uint8_t sts_id);
+
+    /**
+     * @brief Set the mechanical stops used in wheel mode
+     * @param sts_id Servo ID
+     * @param min_stop Lowest reachable position
+     * @param max_stop Highest reachable position
+     * @return true on success, false if the servo is unknown
+     */
+    bool setStops(uint8_t sts_id, uint16_t min_stop, uint16_t max_stop);
+
+    /**
+     * @brief Read a register of a simulated servo directly
+     * @param sts_id Servo ID
+     * @param address Register address
+     * @return Register value, or nullopt if the servo is unknown
+     */
+    std::optional<uint8_t> getRegister(uint8_t sts_id, uint8_t address);
+
+    /**
+     * @brief Write a register of a simulated servo directly
+     * @param sts_id Servo ID
+     * @param address Register address
+     * @param value New value
+     * @return true on success, false if the servo is unknown
+     */
+    bool setRegister(uint8_t sts_id, uint8_t address, uint8_t value);
+
+    /**
+     * @brief Get the total number of bytes written by the host
+     * @return Transmitted byte count
+     */
+    uint64_t getTxBytes() const { return tx_bytes_; }
+
+    /**
+     * @brief Get the number of writePort() calls that carried data
+     * @return Port write count (each costs one adapter round trip on real hardware)
+     */
+    uint64_t getWriteCount() const { return write_count_; }
+
+    /**
+     * @brief Get the total number of bytes sent by the simulated servos
+     * @return Received byte count
+     */
+    uint64_t getRxBytes() const { return rx_bytes_; }
+
+    /**
+     * @brief Get the total time the bus was occupied
+     * @return Wire time in milliseconds, including return delays
+     */
+    double getBusTime() const { return bus_time_; }
+
+private:
+    struct Servo {
+        std::array<uint8_t, 256> regs;
+        std::vector<uint8_t> reg_write;  // Pending REG_WRITE: address followed by data
+        double position;
+        double time_speed;               // Speed derived from the goal time
+        double last_update;
+        uint16_t min_stop;
+        uint16_t max_stop;
+    };
+
+    struct RxByte {
+        double arrival;
+        uint8_t value;
+    };
+
+    void handlePacket(const std::vector<uint8_t>& packet, double tx_end);
+    void writeRegisters(uint8_t sts_id, Servo& servo, uint8_t address, const uint8_t* data, size_t length);
+    void update(Servo& servo, double now);
+    double reply(uint8_t sts_id, const uint8_t* params, size_t length, double start);
+
+    std::map<uint8_t, Servo> servos_;
+    std::vector<uint8_t> tx_buffer_;
+    std::deque<RxByte> rx_buffer_;
+    double bus_free_at_;
+    double bus_time_;
+    uint64_t tx_bytes_;
+    uint64_t write_count_;
+    uint64_t rx_bytes_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_SIMULATED_PORT_HANDLER_H
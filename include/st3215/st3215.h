@@ -14,6 +14,16 @@
 
 namespace st3215 {
 
+/**
+ * @brief One servo's part of a time-parameterized sync move
+ */
+struct TimedMove {
+    uint8_t sts_id;       ///< Servo ID
+    uint16_t position;    ///< Goal position (0-4095)
+    uint16_t time_ms;     ///< Move duration in milliseconds (0: goal speed governs)
+    uint16_t speed = 0;   ///< Speed cap in step/s (0: none, see ST3215::moveInTime())
+};
+
 /**
  * @brief Main class for controlling ST3215 servo motors
  * 
@@ -25,10 +35,40 @@ public:
     /**
      * @brief Constructor
      * @param device Serial port device name (e.g., "/dev/ttyUSB0")
-     * @throws std::runtime_error if port cannot be opened
+     * @throws std::runtime_error if port cannot be opened (aborts in ST3215_EMBEDDED builds)
      */
     explicit ST3215(const std::string& device);
 
+    /**
+     * @brief Constructor using an existing port handler
+     *
+     * Allows a simulated bus (e.g. SimulatedPortHandler) or a port with an
+     * injected clock to be used instead of a serial device.
+     *
+     * @param port_handler Port handler to take ownership of
+     * @throws std::runtime_error if port_handler is null or cannot be opened
+     *         (aborts in ST3215_EMBEDDED builds)
+     */
+    explicit ST3215(std::unique_ptr<PortHandler> port_handler);
+
+    /**
+     * @brief Open a servo bus without throwing
+     *
+     * Use this in builds without exceptions (ST3215_EMBEDDED), where the
+     * constructors abort if the port cannot be opened.
+     *
+     * @param device Serial port device name (e.g., "/dev/ttyUSB0")
+     * @return Servo bus, or nullptr if the port cannot be opened
+     */
+    static std::unique_ptr<ST3215> open(const std::string& device);
+
+    /**
+     * @brief Open a servo bus on an existing port handler without throwing
+     * @param port_handler Port handler to take ownership of
+     * @return Servo bus, or nullptr if port_handler is null or cannot be opened
+     */
+    static std::unique_ptr<ST3215> open(std::unique_ptr<PortHandler> port_handler);
+
     /**
      * @brief Destructor
      */
@@ -206,6 +246,72 @@ public:
      */
     bool writePosition(uint8_t sts_id, uint16_t position);
 
+    /**
+     * @brief Move servo to target position in a given time
+     *
+     * Writes the goal position, goal time and goal speed in one packet, so
+     * the servo plans its own profile to arrive after time_ms. The servo
+     * must already be in position mode.
+     *
+     * With max_speed 0 the goal speed is cleared and only the time governs.
+     * Firmware that ignores the goal time reads a zero goal speed as "no
+     * limit" and moves at full speed; pass max_speed to bound the move on
+     * such servos (and to cap time_ms moves that would need more speed).
+     *
+     * @param sts_id Servo ID
+     * @param position Target position (0-4095)
+     * @param time_ms Move duration in milliseconds
+     * @param wait Wait for the move duration (default: false)
+     * @param max_speed Goal speed in step/s, clamped to MAX_SPEED (default: 0, none)
+     * @return true on success, false on error or if position exceeds MAX_POSITION
+     */
+    bool moveInTime(uint8_t sts_id, uint16_t position, uint16_t time_ms, bool wait = false, uint16_t max_speed = 0);
+
+    /**
+     * @brief Move several servos, each in its own time, with one sync write
+     *
+     * Sends one [POS_L, POS_H, TIME_L, TIME_H, SPEED_L, SPEED_H] record per
+     * servo to STS_GOAL_POSITION_L. Servos given the same time arrive
+     * together. A move's speed caps it like max_speed in moveInTime(); with
+     * speed 0 the goal speed is cleared. No replies are sent.
+     *
+     * @param moves Servo IDs, goal positions, durations and speed caps (unique IDs)
+     * @return Communication result (COMM_NOT_AVAILABLE if moves is empty,
+     *         lists an ID twice or has a position above MAX_POSITION)
+     */
+    int syncMoveInTime(const std::vector<TimedMove>& moves);
+
+    // Write Batching
+
+    /**
+     * @brief Start collecting setter calls into sync writes
+     *
+     * Until flushBatch(), setAcceleration(), setSpeed(), writePosition() and
+     * correctPosition() only record their registers and return true. Other
+     * operations (including moveTo()) still go out immediately.
+     */
+    void beginBatch() { batching_ = true; }
+
+    /**
+     * @brief Send the collected writes and stop batching
+     *
+     * Writes are merged per servo into contiguous register spans (a later
+     * write to the same register wins), spans with the same address and
+     * length are grouped across servos, and each group is sent as one
+     * INST_SYNC_WRITE, split only where it exceeds the packet size. Sync
+     * writes are not acknowledged.
+     *
+     * @return Communication result of the first failed packet, or
+     *         COMM_SUCCESS (also if nothing was collected)
+     */
+    int flushBatch();
+
+    /**
+     * @brief Check whether setter calls are being batched
+     * @return true between beginBatch() and flushBatch()
+     */
+    bool isBatching() const { return batching_; }
+
     // EEPROM Operations
 
     /**
@@ -262,7 +368,41 @@ private:
      */
     std::optional<uint16_t> getBlockPosition(uint8_t sts_id);
 
+    /**
+     * @brief Write registers with acknowledgement, or record them while batching
+     * @param sts_id Servo ID
+     * @param address Start address
+     * @param data Register bytes
+     * @param length Number of bytes
+     * @return true on success or when recorded, false on error
+     */
+    bool writeOrBatch(uint8_t sts_id, uint8_t address, const uint8_t* data, uint8_t length);
+
+    /// One register byte recorded while batching
+    struct BatchByte {
+        uint8_t sts_id;
+        uint8_t address;
+        uint8_t value;
+    };
+
+    /// Contiguous registers of one servo, sent as one sync write record
+    struct BatchSpan {
+        uint8_t address;
+        uint8_t length;
+        uint8_t sts_id;
+        size_t first;  // Index of the first byte in batch_
+    };
+
+    /// Tag for the constructor used by open() on an already opened port
+    struct Opened {};
+    ST3215(std::unique_ptr<PortHandler> port_handler, Opened);
+
     std::unique_ptr<PortHandler> port_handler_;
+    std::unique_ptr<GroupSyncWrite> goal_sync_write_;  // Goal position, time and speed records
+    bool batching_ = false;
+    std::vector<BatchByte> batch_;
+    std::vector<BatchSpan> batch_spans_;
+    std::vector<uint8_t> batch_param_;
     std::mutex lock_;
 };
 
@@ -0,0 +1,95 @@
+#ifndef ST3215_SYNC_CYCLE_H
+#define ST3215_SYNC_CYCLE_H
+
+#include "protocol_packet_handler.h"
+#include "group_sync_write.h"
+#include "group_sync_read.h"
+#include "values.h"
+#include <cstdint>
+
+namespace st3215 {
+
+/**
+ * @brief Timing of the write-then-read cycles run so far
+ *
+ * Times are in milliseconds on the port clock, measured from the start of
+ * the cycle until the sync read reply is complete or timed out.
+ */
+struct SyncCycleStats {
+    uint64_t cycles = 0;     ///< Cycles run
+    uint64_t failed = 0;     ///< Cycles whose write or read failed
+    double last_time = 0.0;  ///< Duration of the last cycle (ms)
+    double mean_time = 0.0;  ///< Mean cycle duration (ms)
+    double max_time = 0.0;   ///< Longest cycle duration (ms)
+};
+
+/**
+ * @brief One control-loop bus cycle: sync write goals, then sync read state
+ *
+ * In fused mode (the default) the sync write is staged and leaves in the
+ * same port write as the sync read request, so the cycle pays the USB
+ * adapter latency once instead of twice and the port flush before the read
+ * cannot discard a write that is still queued. The servos process the two
+ * packets in order, exactly as if they had been sent separately.
+ *
+ * The groups are used as-is: fill the sync write group before each run()
+ * and parse the sync read group afterwards.
+ */
+class SyncCycle {
+public:
+    /**
+     * @brief Constructor
+     * @param ph Protocol packet handler both groups use
+     * @param sync_write Group written at the start of every cycle
+     * @param sync_read Group read after the write
+     */
+    SyncCycle(ProtocolPacketHandler* ph, GroupSyncWrite* sync_write, GroupSyncRead* sync_read);
+
+    /**
+     * @brief Run one cycle
+     *
+     * An empty write group is skipped and an empty read group sends the
+     * write alone.
+     *
+     * @return Result of the sync read, or of the write if it failed or
+     *         nothing was read (COMM_NOT_AVAILABLE if both groups are empty)
+     */
+    int run();
+
+    /**
+     * @brief Choose between one fused port write and two separate ones
+     * @param fused Stage the write with the read request (default: true)
+     */
+    void setFused(bool fused) { fused_ = fused; }
+
+    /**
+     * @brief Check whether cycles are fused
+     * @return true if the write is sent with the read request
+     */
+    bool isFused() const { return fused_; }
+
+    /**
+     * @brief Get the cycle timing
+     * @return Statistics since construction or the last resetStats()
+     */
+    const SyncCycleStats& getStats() const { return stats_; }
+
+    /**
+     * @brief Reset the cycle timing
+     */
+    void resetStats() { stats_ = SyncCycleStats(); }
+
+private:
+    int runFused();
+    int runSeparate();
+
+    ProtocolPacketHandler* ph_;
+    GroupSyncWrite* sync_write_;
+    GroupSyncRead* sync_read_;
+    bool fused_;
+    SyncCycleStats stats_;
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_SYNC_CYCLE_H
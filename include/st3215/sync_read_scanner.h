@@ -0,0 +1,61 @@
+#ifndef ST3215_SYNC_READ_SCANNER_H
+#define ST3215_SYNC_READ_SCANNER_H
+
+#include "values.h"
+#include <vector>
+#include <cstdint>
+
+namespace st3215 {
+
+/**
+ * @brief Bulk validator for sync read replies
+ *
+ * A healthy sync read reply is one status frame per requested ID, back to
+ * back and in request order. The scanner precomputes that layout once per
+ * ID list, then checks a reply in two branch-free passes: a masked compare
+ * of every header, ID, length and error byte against the expected layout
+ * (vectorized by the compiler), and word-at-a-time checksums of all frames.
+ *
+ * If scan() fails, the caller falls back to searching the reply per ID,
+ * which handles missing, reordered or corrupt frames.
+ */
+class SyncReadScanner {
+public:
+    SyncReadScanner();
+
+    /**
+     * @brief Set the expected reply layout
+     * @param ids Requested servo IDs, in request order
+     * @param data_length Data length per servo
+     */
+    void reset(const std::vector<uint8_t>& ids, uint8_t data_length);
+
+    /**
+     * @brief Check that a reply matches the expected layout and all checksums
+     * @param rxpacket Raw sync read reply
+     * @return true if every frame is present, in order and intact
+     */
+    bool scan(const std::vector<uint8_t>& rxpacket) const;
+
+    /**
+     * @brief Get the size of one status frame
+     * @return Frame size in bytes (data length + 6)
+     */
+    size_t getStride() const { return stride_; }
+
+    /**
+     * @brief Get the number of expected frames
+     * @return Frame count
+     */
+    size_t getCount() const { return count_; }
+
+private:
+    size_t stride_;
+    size_t count_;
+    std::vector<uint8_t> expected_;  // Expected bytes where mask_ is set
+    std::vector<uint8_t> mask_;      // Bits that must match expected_
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_SYNC_READ_SCANNER_H
@@ -0,0 +1,111 @@
+#ifndef ST3215_TELEMETRY_CODEC_H
+#define ST3215_TELEMETRY_CODEC_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace st3215 {
+
+/**
+ * @brief One telemetry record of a servo, in raw register units
+ */
+struct TelemetrySample {
+    int64_t timestamp;    ///< Time in microseconds
+    int32_t position;     ///< Present position (steps)
+    int32_t speed;        ///< Present speed (steps/s, signed)
+    int32_t load;         ///< Present load (0.1 %, signed)
+    int32_t current;      ///< Present current (raw)
+    uint8_t voltage;      ///< Present voltage (0.1 V)
+    uint8_t temperature;  ///< Present temperature (°C)
+};
+
+/**
+ * @brief Streaming block encoder for servo telemetry
+ *
+ * Samples are appended one at a time at loop rate and encoded column by
+ * column into self-contained blocks:
+ * - timestamps as zig-zag delta-of-deltas (a steady rate packs to zero bits)
+ * - position, speed, load and current as zig-zag deltas
+ * - voltage and temperature as run-length pairs
+ *
+ * Each numeric column stores its leading values as varints, then a width
+ * byte and every remaining value bit-packed at that width, so decoding is a
+ * fixed-stride unpack and a prefix sum with no per-value branching.
+ *
+ * Block layout: magic "ST", version, varint sample count, the five packed
+ * columns, then the two run-length columns (varint byte size, then
+ * value/varint-run pairs). Blocks can be concatenated into one stream.
+ */
+class TelemetryEncoder {
+public:
+    /// Largest block the encoder writes and the decoder accepts
+    static constexpr size_t MAX_BLOCK_SAMPLES = 1 << 20;
+
+    /**
+     * @brief Constructor
+     * @param block_samples Samples per block (default: 4096, at most MAX_BLOCK_SAMPLES)
+     */
+    explicit TelemetryEncoder(size_t block_samples = 4096);
+
+    /**
+     * @brief Append a sample to the current block
+     * @param sample Telemetry sample
+     * @return true if the block is full and should be flushed
+     */
+    bool append(const TelemetrySample& sample);
+
+    /**
+     * @brief Get the number of samples in the current block
+     * @return Sample count
+     */
+    size_t size() const { return count_; }
+
+    /**
+     * @brief Encode the current block and start a new one
+     * @return Encoded block (empty if no samples were appended)
+     */
+    std::vector<uint8_t> flush();
+
+private:
+    void reset();
+    void endRun(size_t channel);
+
+    size_t block_samples_;
+    size_t count_;
+    std::array<std::vector<uint64_t>, 5> values_;  // zig-zag time, position, speed, load, current
+    std::array<std::vector<uint8_t>, 2> runs_;     // voltage, temperature run-length pairs
+    uint64_t last_timestamp_;
+    uint64_t last_interval_;
+    std::array<uint64_t, 4> last_value_;      // position, speed, load, current
+    std::array<uint8_t, 2> run_value_;        // voltage, temperature
+    std::array<uint64_t, 2> run_length_;
+};
+
+/**
+ * @brief Block decoder for TelemetryEncoder output
+ */
+class TelemetryDecoder {
+public:
+    /**
+     * @brief Decode one block, appending its samples
+     * @param data Encoded data starting at a block
+     * @param size Bytes available
+     * @param samples Output samples (appended)
+     * @return Bytes consumed, or 0 if the block is malformed
+     */
+    static size_t decodeBlock(const uint8_t* data, size_t size, std::vector<TelemetrySample>& samples);
+
+    /**
+     * @brief Decode a stream of concatenated blocks
+     * @param stream Encoded stream
+     * @param samples Output samples (appended)
+     * @return true if the whole stream was decoded
+     */
+    static bool decode(const std::vector<uint8_t>& stream, std::vector<TelemetrySample>& samples);
+};
+
+}  // namespace st3215
+
+#endif  // ST3215_TELEMETRY_CODEC_H
@@ -1,6 +1,7 @@
 #ifndef ST3215_VALUES_H
 #define ST3215_VALUES_H
 
+#include <cstddef>
 #include <cstdint>
 
 namespace st3215 {
@@ -79,6 +80,7 @@ constexpr uint8_t STS_MODEL_H = 4;
 // EPROM Read-Write Registers
 constexpr uint8_t STS_ID = 5;
 constexpr uint8_t STS_BAUD_RATE = 6;
+constexpr uint8_t STS_RETURN_DELAY_TIME = 7;
 constexpr uint8_t STS_MIN_ANGLE_LIMIT_L = 9;
 constexpr uint8_t STS_MIN_ANGLE_LIMIT_H = 10;
 constexpr uint8_t STS_MAX_ANGLE_LIMIT_L = 11;
@@ -0,0 +1,74 @@
+#include "st3215/bus_cost_model.h"
+
+namespace st3215 {
+
+BusCostModel::BusCostModel(uint32_t baudrate)
+    : byte_time_(0.0), default_return_delay_(0.0) {
+    setBaudRate(baudrate);
+}
+
+void BusCostModel::setBaudRate(uint32_t baudrate) {
+    byte_time_ = (1000.0 / baudrate) * 10.0;
+}
+
+double BusCostModel::getReturnDelay(uint8_t sts_id) const {
+    auto it = return_delay_.find(sts_id);
+    return (it != return_delay_.end()) ? it->second : default_return_delay_;
+}
+
+int BusCostModel::loadReturnDelays(ProtocolPacketHandler* ph, const std::vector<uint8_t>& ids) {
+    for (uint8_t sts_id : ids) {
+        auto [value, result, error] = ph->read1ByteTxRx(sts_id, STS_RETURN_DELAY_TIME);
+        if (result != COMM_SUCCESS) {
+            return result;
+        }
+        setReturnDelay(sts_id, value * 2.0);  // Register unit is 2 us
+    }
+    return COMM_SUCCESS;
+}
+
+double BusCostModel::replyTime(uint8_t sts_id, uint8_t length) const {
+    // Status packet: HEADER0 HEADER1 ID LENGTH ERROR DATA... CHKSUM
+    return getReturnDelay(sts_id) / 1000.0 + packetTime(6 + length);
+}
+
+double BusCostModel::pingTime(uint8_t sts_id) const {
+    return packetTime(6) + replyTime(sts_id, 0);
+}
+
+double BusCostModel::readTime(uint8_t sts_id, uint8_t length) const {
+    // Instruction packet parameters: ADDRESS LENGTH
+    return packetTime(8) + replyTime(sts_id, length);
+}
+
+double BusCostModel::writeTime(uint8_t sts_id, uint8_t length) const {
+    // Instruction packet parameters: ADDRESS DATA...
+    return packetTime(7 + length) + replyTime(sts_id, 0);
+}
+
+double BusCostModel::actionTime(uint8_t sts_id) const {
+    double time = packetTime(6);
+    if (sts_id != BROADCAST_ID) {
+        time += replyTime(sts_id, 0);
+    }
+    return time;
+}
+
+double BusCostModel::syncWriteTime(size_t servo_count, uint8_t length) const {
+    // Instruction packet parameters: ADDRESS LENGTH [ID DATA...] per servo
+    size_t per_packet = maxSyncWriteServos(length);
+    size_t packets = (servo_count + per_packet - 1) / per_packet;
+    return packetTime(8 * packets + servo_count * (1 + length));
+}
+
+double BusCostModel::syncReadTime(const std::vector<uint8_t>& ids, uint8_t length) const {
+    // Instruction packet parameters: ADDRESS LENGTH ID...
+    size_t packets = (ids.size() + maxSyncReadServos() - 1) / maxSyncReadServos();
+    double time = packetTime(8 * packets + ids.size());
+    for (uint8_t sts_id : ids) {
+        time += replyTime(sts_id, length);
+    }
+    return time;
+}
+
+}  // namespace st3215
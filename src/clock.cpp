@@ -0,0 +1,49 @@
+#include "st3215/clock.h"
+#include <chrono>
+#include <thread>
+
+namespace st3215 {
+
+void Clock::sleepUntil(double msec) {
+    sleepFor(msec - now());
+}
+
+void Clock::spinUntil(double msec) {
+    sleepUntil(msec);
+}
+
+double SystemClock::now() {
+    auto duration = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void SystemClock::sleepFor(double msec) {
+    if (msec > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(msec));
+    }
+}
+
+void SystemClock::spinUntil(double msec) {
+    while (now() < msec) {
+        std::this_thread::yield();
+    }
+}
+
+SystemClock* SystemClock::instance() {
+    static SystemClock clock;
+    return &clock;
+}
+
+void VirtualClock::sleepFor(double msec) {
+    if (msec > 0.0) {
+        now_ += msec;
+    }
+}
+
+void VirtualClock::sleepUntil(double msec) {
+    if (msec > now_) {
+        now_ = msec;
+    }
+}
+
+}  // namespace st3215
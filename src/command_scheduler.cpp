@@ -0,0 +1,158 @@
+#include "st3215/command_scheduler.h"
+#include <algorithm>
+
+namespace st3215 {
+
+CommandScheduler::CommandScheduler(ProtocolPacketHandler* ph)
+    : ph_(ph),
+      next_handle_(1),
+      guard_(0.5),
+      spin_margin_(1.0),
+      dispatched_(0),
+      failed_(0),
+      error_sum_(0.0),
+      error_max_(0.0) {
+}
+
+uint64_t CommandScheduler::scheduleWrite(double at_msec, uint8_t sts_id, uint8_t address,
+                                         const std::vector<uint8_t>& data) {
+    if (sts_id >= BROADCAST_ID || data.empty() || data.size() > TXPACKET_MAX_LEN - 7) {
+        return 0;
+    }
+
+    return schedule(at_msec, {Type::WRITE, sts_id, address, static_cast<uint8_t>(data.size()), data});
+}
+
+uint64_t CommandScheduler::scheduleSyncWrite(double at_msec, uint8_t address, uint8_t length,
+                                             const std::map<uint8_t, std::vector<uint8_t>>& data) {
+    if (data.empty() || length == 0 || data.size() * (1 + length) > TXPACKET_MAX_LEN - 8) {
+        return 0;
+    }
+
+    // Sync write parameters: [ID, DATA...] per servo
+    std::vector<uint8_t> param;
+    param.reserve(data.size() * (1 + length));
+    for (const auto& [sts_id, bytes] : data) {
+        if (sts_id >= BROADCAST_ID || bytes.size() != length) {
+            return 0;
+        }
+        param.push_back(sts_id);
+        param.insert(param.end(), bytes.begin(), bytes.end());
+    }
+
+    return schedule(at_msec, {Type::SYNC_WRITE, BROADCAST_ID, address, length, std::move(param)});
+}
+
+uint64_t CommandScheduler::scheduleAction(double at_msec, uint8_t sts_id) {
+    return schedule(at_msec, {Type::ACTION, sts_id, 0, 0, {}});
+}
+
+uint64_t CommandScheduler::schedule(double at_msec, Command command) {
+    uint64_t handle = next_handle_++;
+    commands_.emplace(Key(at_msec, handle), std::move(command));
+    return handle;
+}
+
+bool CommandScheduler::cancel(uint64_t handle) {
+    auto it = std::find_if(commands_.begin(), commands_.end(),
+                           [handle](const auto& entry) { return entry.first.second == handle; });
+    if (it == commands_.end()) {
+        return false;
+    }
+
+    commands_.erase(it);
+    return true;
+}
+
+std::optional<double> CommandScheduler::nextDeadline() const {
+    if (commands_.empty()) {
+        return std::nullopt;
+    }
+    return commands_.begin()->first.first;
+}
+
+bool CommandScheduler::fits(double duration_msec) const {
+    if (commands_.empty()) {
+        return true;
+    }
+
+    double now = ph_->getPortHandler()->getClock()->now();
+    return now + duration_msec + guard_ <= commands_.begin()->first.first;
+}
+
+size_t CommandScheduler::dispatchDue() {
+    Clock* clock = ph_->getPortHandler()->getClock();
+    size_t count = 0;
+
+    while (!commands_.empty() && commands_.begin()->first.first <= clock->now()) {
+        auto node = commands_.extract(commands_.begin());
+        dispatch(node.key(), node.mapped());
+        ++count;
+    }
+    return count;
+}
+
+size_t CommandScheduler::runUntil(double until_msec) {
+    Clock* clock = ph_->getPortHandler()->getClock();
+    size_t count = 0;
+
+    while (!commands_.empty() && commands_.begin()->first.first <= until_msec) {
+        double deadline = commands_.begin()->first.first;
+
+        // Sleep coarsely, then spin the last stretch for sub-millisecond accuracy
+        clock->sleepUntil(deadline - spin_margin_);
+        clock->spinUntil(deadline);
+
+        auto node = commands_.extract(commands_.begin());
+        dispatch(node.key(), node.mapped());
+        ++count;
+    }
+
+    clock->sleepUntil(until_msec);
+    return count;
+}
+
+void CommandScheduler::dispatch(const Key& key, const Command& command) {
+    double error = ph_->getPortHandler()->getClock()->now() - key.first;
+
+    int result = COMM_SUCCESS;
+    switch (command.type) {
+        case Type::WRITE: {
+            // Wait for the status reply so the next command cannot collide with it
+            uint8_t error_byte;
+            std::tie(result, error_byte) = ph_->writeTxRx(command.sts_id, command.address, command.length, command.data);
+            break;
+        }
+        case Type::SYNC_WRITE:
+            result = ph_->syncWriteTxOnly(command.address, command.length, command.data, command.data.size());
+            break;
+        case Type::ACTION:
+            result = ph_->action(command.sts_id);
+            break;
+    }
+
+    ++dispatched_;
+    if (result != COMM_SUCCESS) {
+        ++failed_;
+    }
+    error_sum_ += error;
+    error_max_ = std::max(error_max_, error);
+}
+
+DispatchStats CommandScheduler::getStats() const {
+    DispatchStats stats;
+    stats.dispatched = dispatched_;
+    stats.failed = failed_;
+    stats.mean_error = (dispatched_ > 0) ? error_sum_ / dispatched_ : 0.0;
+    stats.max_error = error_max_;
+    return stats;
+}
+
+void CommandScheduler::resetStats() {
+    dispatched_ = 0;
+    failed_ = 0;
+    error_sum_ = 0.0;
+    error_max_ = 0.0;
+}
+
+}  // namespace st3215
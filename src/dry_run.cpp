@@ -0,0 +1,59 @@
+#include "st3215/dry_run.h"
+#include <algorithm>
+
+namespace st3215 {
+
+DryRun::DryRun(uint32_t baudrate) {
+    auto port = std::make_unique<SimulatedPortHandler>(&clock_);
+    port->setBaudRate(baudrate);
+    port_ = port.get();
+    servo_ = std::make_unique<ST3215>(std::move(port));
+}
+
+DryRunReport DryRun::run(double period_msec, size_t cycles, const std::function<int(ST3215&, size_t)>& body) {
+    DryRunReport report;
+    report.period = period_msec;
+    report.cycles.reserve(cycles);
+
+    uint64_t tx_start = port_->getTxBytes();
+    uint64_t rx_start = port_->getRxBytes();
+    double cycle_start = clock_.now();
+
+    for (size_t i = 0; i < cycles; ++i) {
+        double bus_start = port_->getBusTime();
+
+        // A rejected packet never reaches the bus, so only the result shows it
+        if (body(*servo_, i) != COMM_SUCCESS) {
+            report.failures++;
+        }
+
+        CycleTiming timing;
+        timing.bus_time = port_->getBusTime() - bus_start;
+        timing.busy_time = clock_.now() - cycle_start;
+        report.cycles.push_back(timing);
+
+        report.mean_bus_time += timing.bus_time;
+        report.mean_busy_time += timing.busy_time;
+        report.max_bus_time = std::max(report.max_bus_time, timing.bus_time);
+        report.max_busy_time = std::max(report.max_busy_time, timing.busy_time);
+        if (timing.busy_time > period_msec || timing.bus_time > period_msec) {
+            report.overruns++;
+        }
+
+        // An overrunning cycle delays the next one, as a real loop would
+        cycle_start = std::max(cycle_start + period_msec, clock_.now());
+        clock_.sleepUntil(cycle_start);
+    }
+
+    if (cycles > 0) {
+        report.mean_bus_time /= cycles;
+        report.mean_busy_time /= cycles;
+    }
+    report.occupancy = (period_msec > 0.0) ? report.mean_bus_time / period_msec : 0.0;
+    report.feasible = (report.overruns == 0 && report.failures == 0);
+    report.tx_bytes = port_->getTxBytes() - tx_start;
+    report.rx_bytes = port_->getRxBytes() - rx_start;
+    return report;
+}
+
+}  // namespace st3215
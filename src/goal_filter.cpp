@@ -0,0 +1,219 @@
+#include "st3215/goal_filter.h"
+#include "st3215/group_sync_read.h"
+#include <algorithm>
+
+namespace st3215 {
+
+namespace {
+
+// Branch-free pass over the parallel arrays; the restrict qualifiers let the
+// compiler vectorize it without runtime alias checks
+uint32_t filterGoals(size_t count, const int32_t* __restrict__ goal, const int32_t* __restrict__ lo,
+                     const int32_t* __restrict__ hi, const int32_t* __restrict__ slew,
+                     const int32_t* __restrict__ deadband, const int32_t* __restrict__ last,
+                     int32_t* __restrict__ out, uint8_t* __restrict__ changed) {
+    uint32_t changed_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int32_t clamped = std::min(std::max(goal[i], lo[i]), hi[i]);
+        int32_t distance = clamped - last[i];
+        int32_t magnitude = (distance < 0) ? -distance : distance;
+        // Deadband on the full distance, so a slew limit at or below the
+        // deadband still lets the servo move
+        int32_t moved = (magnitude > deadband[i]) ? 1 : 0;
+        int32_t step = std::min(std::max(distance, -slew[i]), slew[i]);
+        out[i] = last[i] + step * moved;
+        changed[i] = static_cast<uint8_t>(moved);
+        changed_count += static_cast<uint32_t>(moved);
+    }
+    return changed_count;
+}
+
+}  // namespace
+
+GoalFilter::GoalFilter(ProtocolPacketHandler* ph)
+    : ph_(ph), sync_write_(ph, STS_GOAL_POSITION_L, 2) {
+}
+
+bool GoalFilter::addServo(uint8_t sts_id, uint16_t current_position, uint16_t min_limit, uint16_t max_limit) {
+    if (index_.find(sts_id) != index_.end()) {
+        return false;
+    }
+
+    index_[sts_id] = ids_.size();
+    ids_.push_back(sts_id);
+    goal_.push_back(current_position);
+    min_.push_back(std::min(std::min(min_limit, max_limit), MAX_POSITION));
+    max_.push_back(std::min(std::max(min_limit, max_limit), MAX_POSITION));
+    slew_.push_back(MAX_POSITION);
+    deadband_.push_back(0);
+    last_.push_back(current_position);
+    out_.push_back(current_position);
+    changed_.push_back(0);
+    return true;
+}
+
+void GoalFilter::removeServo(uint8_t sts_id) {
+    auto it = index_.find(sts_id);
+    if (it == index_.end()) {
+        return;
+    }
+
+    // Move the last slot into the freed one to keep the arrays dense
+    size_t i = it->second;
+    size_t last = ids_.size() - 1;
+    index_.erase(it);
+    if (i != last) {
+        ids_[i] = ids_[last];
+        goal_[i] = goal_[last];
+        min_[i] = min_[last];
+        max_[i] = max_[last];
+        slew_[i] = slew_[last];
+        deadband_[i] = deadband_[last];
+        last_[i] = last_[last];
+        out_[i] = out_[last];
+        changed_[i] = changed_[last];
+        index_[ids_[i]] = i;
+    }
+
+    ids_.pop_back();
+    goal_.pop_back();
+    min_.pop_back();
+    max_.pop_back();
+    slew_.pop_back();
+    deadband_.pop_back();
+    last_.pop_back();
+    out_.pop_back();
+    changed_.pop_back();
+}
+
+int GoalFilter::loadLimits() {
+    if (ids_.empty()) {
+        return COMM_NOT_AVAILABLE;
+    }
+
+    GroupSyncRead sync_read(ph_, STS_MIN_ANGLE_LIMIT_L, 4);
+    for (uint8_t sts_id : ids_) {
+        sync_read.addParam(sts_id);
+    }
+
+    // A missing or corrupt reply only affects its own servo, so cache every
+    // slot that arrived intact before reporting the error
+    int result = sync_read.txRxPacket();
+    if (result != COMM_SUCCESS && result != COMM_RX_TIMEOUT && result != COMM_RX_CORRUPT) {
+        return result;
+    }
+
+    for (size_t i = 0; i < ids_.size(); ++i) {
+        auto [available, error] = sync_read.isAvailable(ids_[i], STS_MIN_ANGLE_LIMIT_L, 4);
+        if (!available) {
+            if (result == COMM_SUCCESS) {
+                result = COMM_RX_CORRUPT;
+            }
+            continue;
+        }
+
+        uint16_t min_limit = static_cast<uint16_t>(sync_read.getData(ids_[i], STS_MIN_ANGLE_LIMIT_L, 2));
+        uint16_t max_limit = static_cast<uint16_t>(sync_read.getData(ids_[i], STS_MAX_ANGLE_LIMIT_L, 2));
+        if (min_limit == 0 && max_limit == 0) {
+            min_limit = MIN_POSITION;
+            max_limit = MAX_POSITION;
+        }
+        min_[i] = std::min(min_limit, max_limit);
+        max_[i] = std::min(std::max(min_limit, max_limit), MAX_POSITION);
+    }
+
+    return result;
+}
+
+bool GoalFilter::setLimits(uint8_t sts_id, uint16_t min_limit, uint16_t max_limit) {
+    auto it = index_.find(sts_id);
+    if (it == index_.end() || min_limit > max_limit) {
+        return false;
+    }
+
+    min_[it->second] = std::min(min_limit, MAX_POSITION);
+    max_[it->second] = std::min(max_limit, MAX_POSITION);
+    return true;
+}
+
+bool GoalFilter::setSlewLimit(uint8_t sts_id, uint16_t max_step) {
+    auto it = index_.find(sts_id);
+    if (it == index_.end()) {
+        return false;
+    }
+
+    slew_[it->second] = (max_step == 0) ? MAX_POSITION : max_step;
+    return true;
+}
+
+bool GoalFilter::setDeadband(uint8_t sts_id, uint16_t deadband) {
+    auto it = index_.find(sts_id);
+    if (it == index_.end()) {
+        return false;
+    }
+
+    deadband_[it->second] = deadband;
+    return true;
+}
+
+bool GoalFilter::setGoal(uint8_t sts_id, int32_t position) {
+    auto it = index_.find(sts_id);
+    if (it == index_.end()) {
+        return false;
+    }
+
+    goal_[it->second] = position;
+    return true;
+}
+
+size_t GoalFilter::apply() {
+    return filterGoals(ids_.size(), goal_.data(), min_.data(), max_.data(), slew_.data(), deadband_.data(),
+                       last_.data(), out_.data(), changed_.data());
+}
+
+bool GoalFilter::isChanged(uint8_t sts_id) const {
+    auto it = index_.find(sts_id);
+    if (it == index_.end()) {
+        return false;
+    }
+    return changed_[it->second] != 0;
+}
+
+std::optional<uint16_t> GoalFilter::getFiltered(uint8_t sts_id) const {
+    auto it = index_.find(sts_id);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return static_cast<uint16_t>(out_[it->second]);
+}
+
+int GoalFilter::txPacket() {
+    sync_write_.clearParam();
+    bool has_param = false;
+
+    for (size_t i = 0; i < ids_.size(); ++i) {
+        if (!changed_[i]) {
+            continue;
+        }
+        uint16_t position = static_cast<uint16_t>(out_[i]);
+        sync_write_.addParam(ids_[i], {ph_->lobyte(position), ph_->hibyte(position)});
+        has_param = true;
+    }
+
+    if (!has_param) {
+        return COMM_SUCCESS;
+    }
+
+    int result = sync_write_.txPacket();
+    if (result == COMM_SUCCESS) {
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            if (changed_[i]) {
+                last_[i] = out_[i];
+                changed_[i] = 0;
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace st3215
@@ -0,0 +1,109 @@
+#include "st3215/goal_mailbox.h"
+
+namespace st3215 {
+
+GoalMailbox::GoalMailbox(ProtocolPacketHandler* ph)
+    : ph_(ph), sync_write_(ph, STS_GOAL_POSITION_L, 6), taken_{} {
+}
+
+bool GoalMailbox::post(uint8_t sts_id, uint16_t position, uint16_t speed) {
+    if (sts_id >= BROADCAST_ID || position > MAX_POSITION) {
+        return false;
+    }
+
+    Slot& slot = slots_[sts_id];
+    uint64_t word = PENDING | (static_cast<uint64_t>(speed) << 16) | position;
+    uint64_t previous = slot.word.exchange(word, std::memory_order_acq_rel);
+
+    slot.posted.store(slot.posted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (previous & PENDING) {
+        slot.conflated.store(slot.conflated.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+int GoalMailbox::txPacket() {
+    sync_write_.clearParam();
+    bool has_param = false;
+
+    for (size_t id = 0; id < slots_.size(); ++id) {
+        Slot& slot = slots_[id];
+        taken_[id] = 0;
+        if (!(slot.word.load(std::memory_order_acquire) & PENDING)) {
+            continue;
+        }
+
+        // Clearing the flag returns whatever was newest at that instant
+        uint64_t word = slot.word.fetch_and(~PENDING, std::memory_order_acq_rel);
+        if (!(word & PENDING)) {
+            continue;
+        }
+        taken_[id] = word;
+
+        uint16_t position = static_cast<uint16_t>(word & 0xFFFF);
+        uint16_t speed = static_cast<uint16_t>((word >> 16) & 0xFFFF);
+        sync_write_.addParam(static_cast<uint8_t>(id), {
+            ph_->lobyte(position), ph_->hibyte(position),
+            0, 0,
+            ph_->lobyte(speed), ph_->hibyte(speed)
+        });
+        has_param = true;
+    }
+
+    if (!has_param) {
+        return COMM_SUCCESS;
+    }
+
+    int result = sync_write_.txPacket();
+
+    for (size_t id = 0; id < slots_.size(); ++id) {
+        if (!taken_[id]) {
+            continue;
+        }
+        Slot& slot = slots_[id];
+        if (result == COMM_SUCCESS) {
+            slot.delivered.store(slot.delivered.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else {
+            // Re-arm the goal unless the writer already replaced it; the
+            // writer saw no pending goal then, so the loss is counted here
+            uint64_t expected = taken_[id] & ~PENDING;
+            if (!slot.word.compare_exchange_strong(expected, taken_[id], std::memory_order_acq_rel)) {
+                slot.superseded.store(slot.superseded.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    return result;
+}
+
+uint64_t GoalMailbox::getPosted(uint8_t sts_id) const {
+    if (sts_id >= BROADCAST_ID) {
+        return 0;
+    }
+    return slots_[sts_id].posted.load(std::memory_order_relaxed);
+}
+
+uint64_t GoalMailbox::getConflated(uint8_t sts_id) const {
+    if (sts_id >= BROADCAST_ID) {
+        return 0;
+    }
+    const Slot& slot = slots_[sts_id];
+    return slot.conflated.load(std::memory_order_relaxed) + slot.superseded.load(std::memory_order_relaxed);
+}
+
+uint64_t GoalMailbox::getDelivered(uint8_t sts_id) const {
+    if (sts_id >= BROADCAST_ID) {
+        return 0;
+    }
+    return slots_[sts_id].delivered.load(std::memory_order_relaxed);
+}
+
+uint64_t GoalMailbox::getTotalConflated() const {
+    uint64_t total = 0;
+    for (const auto& slot : slots_) {
+        total += slot.conflated.load(std::memory_order_relaxed) + slot.superseded.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+}  // namespace st3215
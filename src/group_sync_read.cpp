@@ -1,4 +1,6 @@
 #include "st3215/group_sync_read.h"
+#include "trace.h"
+#include <algorithm>
 #include <array>
 
 namespace st3215 {
@@ -9,69 +11,95 @@ GroupSyncRead::GroupSyncRead(ProtocolPacketHandler* ph, uint8_t start_address, u
     clearParam();
 }
 
+size_t GroupSyncRead::findSlot(uint8_t sts_id) const {
+    auto it = std::lower_bound(param_.begin(), param_.end(), sts_id);
+    if (it == param_.end() || *it != sts_id) {
+        return param_.size();
+    }
+    return static_cast<size_t>(it - param_.begin());
+}
+
 void GroupSyncRead::makeParam() {
-    if (data_dict_.empty()) {
+    if (param_.empty()) {
         return;
     }
 
-    param_.clear();
-
-    for (const auto& [sts_id, data] : data_dict_) {
-        param_.push_back(sts_id);
-    }
+    scanner_.reset(param_, data_length_);
 }
 
 bool GroupSyncRead::addParam(uint8_t sts_id) {
-    if (data_dict_.find(sts_id) != data_dict_.end()) {
+    auto it = std::lower_bound(param_.begin(), param_.end(), sts_id);
+    if (it != param_.end() && *it == sts_id) {
         return false;
     }
 
-    data_dict_[sts_id] = {};
+    size_t slot = static_cast<size_t>(it - param_.begin());
+    size_t stride = data_length_ + 1;
+    param_.insert(it, sts_id);
+    data_.insert(data_.begin() + slot * stride, stride, 0);
+    valid_.insert(valid_.begin() + slot, 0);
     is_param_changed_ = true;
     return true;
 }
 
 void GroupSyncRead::removeParam(uint8_t sts_id) {
-    if (data_dict_.find(sts_id) == data_dict_.end()) {
+    size_t slot = findSlot(sts_id);
+    if (slot == param_.size()) {
         return;
     }
 
-    data_dict_.erase(sts_id);
+    size_t stride = data_length_ + 1;
+    param_.erase(param_.begin() + slot);
+    data_.erase(data_.begin() + slot * stride, data_.begin() + (slot + 1) * stride);
+    valid_.erase(valid_.begin() + slot);
     is_param_changed_ = true;
 }
 
 void GroupSyncRead::clearParam() {
-    data_dict_.clear();
+    param_.clear();
+    data_.clear();
+    valid_.clear();
+    is_param_changed_ = true;
 }
 
 int GroupSyncRead::txPacket() {
-    if (data_dict_.empty()) {
+    if (param_.empty()) {
         return COMM_NOT_AVAILABLE;
     }
 
-    if (is_param_changed_ || param_.empty()) {
+    if (is_param_changed_) {
         makeParam();
         is_param_changed_ = false;
     }
 
-    return ph_->syncReadTx(start_address_, data_length_, param_, data_dict_.size());
+    return ph_->syncReadTx(start_address_, data_length_, param_, param_.size());
 }
 
 int GroupSyncRead::rxPacket() {
     last_result_ = true;
-    int result = COMM_RX_FAIL;
 
-    if (data_dict_.empty()) {
+    if (param_.empty()) {
         return COMM_NOT_AVAILABLE;
     }
 
-    auto [rx_result, rxpacket] = ph_->syncReadRx(data_length_, data_dict_.size());
-    result = rx_result;
+    int result = ph_->syncReadRx(data_length_, param_.size(), rxpacket_);
+    std::fill(valid_.begin(), valid_.end(), 0);
+    size_t stride = data_length_ + 1;
 
-    if (rxpacket.size() >= static_cast<size_t>((data_length_ + 6))) {
-        for (auto& [sts_id, stored_data] : data_dict_) {
-            auto [data, read_result] = readRx(rxpacket, sts_id, data_length_);
-            stored_data = data;
+    if (!is_param_changed_ && scanner_.getCount() == param_.size() && scanner_.scan(rxpacket_)) {
+        // Every frame intact and in request order: copy [ERROR, DATA...] per slot
+        for (size_t slot = 0; slot < param_.size(); ++slot) {
+            std::copy_n(rxpacket_.begin() + slot * scanner_.getStride() + PKT_ERROR, stride,
+                        data_.begin() + slot * stride);
+            valid_[slot] = 1;
+            ST3215_TRACE2(syncread_slot, param_[slot], COMM_SUCCESS);
+        }
+    } else if (rxpacket_.size() >= static_cast<size_t>((data_length_ + 6))) {
+        // Missing, reordered or corrupt frames: search the reply per ID
+        for (size_t slot = 0; slot < param_.size(); ++slot) {
+            int read_result = findFrame(rxpacket_, param_[slot], data_length_, data_.data() + slot * stride);
+            ST3215_TRACE2(syncread_slot, param_[slot], read_result);
+            valid_[slot] = (read_result == COMM_SUCCESS) ? 1 : 0;
             if (read_result != COMM_SUCCESS) {
                 last_result_ = false;
             }
@@ -91,8 +119,7 @@ int GroupSyncRead::txRxPacket() {
     return rxPacket();
 }
 
-std::tuple<std::vector<uint8_t>, int> GroupSyncRead::readRx(const std::vector<uint8_t>& rxpacket, uint8_t sts_id, uint8_t data_length) {
-    std::vector<uint8_t> data;
+int GroupSyncRead::findFrame(const std::vector<uint8_t>& rxpacket, uint8_t sts_id, uint8_t data_length, uint8_t* slot) const {
     size_t rx_length = rxpacket.size();
     size_t rx_index = 0;
 
@@ -122,51 +149,53 @@ std::tuple<std::vector<uint8_t>, int> GroupSyncRead::readRx(const std::vector<ui
         rx_index++;
 
         uint8_t calSum = sts_id + (data_length + 2) + error_byte;
-        data.clear();
-        data.push_back(error_byte);
+        slot[0] = error_byte;
         for (uint8_t i = 0; i < data_length; ++i) {
-            data.push_back(rxpacket[rx_index]);
+            slot[1 + i] = rxpacket[rx_index];
             calSum += rxpacket[rx_index];
             rx_index++;
         }
         calSum = ~calSum & 0xFF;
 
         if (calSum != rxpacket[rx_index]) {
-            return std::make_tuple(std::vector<uint8_t>(), COMM_RX_CORRUPT);
+            ST3215_TRACE3(checksum_fail, sts_id, calSum, rxpacket[rx_index]);
+            return COMM_RX_CORRUPT;
         }
-        return std::make_tuple(data, COMM_SUCCESS);
+        ST3215_TRACE3(frame_parsed, sts_id, data_length + 2, error_byte);
+        return COMM_SUCCESS;
     }
 
-    return std::make_tuple(std::vector<uint8_t>(), COMM_RX_CORRUPT);
+    return COMM_RX_CORRUPT;
 }
 
-std::tuple<bool, uint8_t> GroupSyncRead::isAvailable(uint8_t sts_id, uint8_t address, uint8_t data_length) {
-    if (data_dict_.find(sts_id) == data_dict_.end()) {
-        return std::make_tuple(false, 0);
-    }
-
-    if (address < start_address_ || (start_address_ + data_length_ - data_length) < address) {
-        return std::make_tuple(false, 0);
+std::tuple<std::vector<uint8_t>, int> GroupSyncRead::readRx(const std::vector<uint8_t>& rxpacket, uint8_t sts_id, uint8_t data_length) {
+    std::vector<uint8_t> data(data_length + 1);
+    int result = findFrame(rxpacket, sts_id, data_length, data.data());
+    if (result != COMM_SUCCESS) {
+        data.clear();
     }
+    return std::make_tuple(data, result);
+}
 
-    const auto& stored_data = data_dict_[sts_id];
-    if (stored_data.empty()) {
+std::tuple<bool, uint8_t> GroupSyncRead::isAvailable(uint8_t sts_id, uint8_t address, uint8_t data_length) {
+    size_t slot = findSlot(sts_id);
+    if (slot == param_.size() || !valid_[slot]) {
         return std::make_tuple(false, 0);
     }
 
-    if (stored_data.size() < static_cast<size_t>(data_length + 1)) {
+    if (address < start_address_ || (start_address_ + data_length_ - data_length) < address) {
         return std::make_tuple(false, 0);
     }
 
-    return std::make_tuple(true, stored_data[0]);
+    return std::make_tuple(true, data_[slot * (data_length_ + 1)]);
 }
 
 uint32_t GroupSyncRead::getData(uint8_t sts_id, uint8_t address, uint8_t data_length) {
-    auto it = data_dict_.find(sts_id);
-    if (it == data_dict_.end()) {
+    size_t slot = findSlot(sts_id);
+    if (slot == param_.size()) {
         return 0;
     }
-    const auto& stored_data = it->second;
+    const uint8_t* stored_data = data_.data() + slot * (data_length_ + 1);
     uint8_t offset = address - start_address_ + 1;
 
     if (data_length == 1) {
@@ -1,53 +1,53 @@
 #include "st3215/group_sync_write.h"
+#include <algorithm>
 
 namespace st3215 {
 
 GroupSyncWrite::GroupSyncWrite(ProtocolPacketHandler* ph, uint8_t start_address, uint8_t data_length)
-    : ph_(ph), start_address_(start_address), data_length_(data_length), is_param_changed_(false) {
+    : ph_(ph), start_address_(start_address), data_length_(data_length) {
+    param_.reserve(TXPACKET_MAX_LEN);
     clearParam();
 }
 
 void GroupSyncWrite::makeParam() {
-    if (data_dict_.empty()) {
-        return;
-    }
-
-    param_.clear();
+}
 
-    for (const auto& [sts_id, data] : data_dict_) {
-        if (data.empty()) {
-            return;
-        }
-        param_.push_back(sts_id);
-        param_.insert(param_.end(), data.begin(), data.end());
+size_t GroupSyncWrite::lowerBound(uint8_t sts_id) const {
+    size_t offset = 0;
+    while (offset < param_.size() && param_[offset] < sts_id) {
+        offset += 1 + data_length_;
     }
+    return offset;
 }
 
 bool GroupSyncWrite::addParam(uint8_t sts_id, const std::vector<uint8_t>& data) {
-    if (data_dict_.find(sts_id) != data_dict_.end()) {
+    if (data.size() > data_length_) {
         return false;
     }
 
-    if (data.size() > data_length_) {
+    size_t offset = lowerBound(sts_id);
+    if (offset < param_.size() && param_[offset] == sts_id) {
         return false;
     }
 
-    data_dict_[sts_id] = data;
-    is_param_changed_ = true;
+    param_.insert(param_.begin() + offset, 1 + data_length_, 0);
+    param_[offset] = sts_id;
+    std::copy(data.begin(), data.end(), param_.begin() + offset + 1);
     return true;
 }
 
 void GroupSyncWrite::removeParam(uint8_t sts_id) {
-    if (data_dict_.find(sts_id) == data_dict_.end()) {
+    size_t offset = lowerBound(sts_id);
+    if (offset >= param_.size() || param_[offset] != sts_id) {
         return;
     }
 
-    data_dict_.erase(sts_id);
-    is_param_changed_ = true;
+    param_.erase(param_.begin() + offset, param_.begin() + offset + 1 + data_length_);
 }
 
 bool GroupSyncWrite::changeParam(uint8_t sts_id, const std::vector<uint8_t>& data) {
-    if (data_dict_.find(sts_id) == data_dict_.end()) {
+    size_t offset = lowerBound(sts_id);
+    if (offset >= param_.size() || param_[offset] != sts_id) {
         return false;
     }
 
@@ -55,27 +55,30 @@ bool GroupSyncWrite::changeParam(uint8_t sts_id, const std::vector<uint8_t>& dat
         return false;
     }
 
-    data_dict_[sts_id] = data;
-    is_param_changed_ = true;
+    auto record = param_.begin() + offset + 1;
+    std::fill(record, record + data_length_, 0);
+    std::copy(data.begin(), data.end(), record);
     return true;
 }
 
 void GroupSyncWrite::clearParam() {
-    data_dict_.clear();
+    param_.clear();
 }
 
 int GroupSyncWrite::txPacket() {
-    if (data_dict_.empty()) {
+    if (param_.empty()) {
         return COMM_NOT_AVAILABLE;
     }
 
-    if (is_param_changed_ || param_.empty()) {
-        makeParam();
-        is_param_changed_ = false;
+    return ph_->syncWriteTxOnly(start_address_, data_length_, param_, param_.size());
+}
+
+int GroupSyncWrite::stagePacket() {
+    if (param_.empty()) {
+        return COMM_NOT_AVAILABLE;
     }
 
-    return ph_->syncWriteTxOnly(start_address_, data_length_, param_,
-                                 data_dict_.size() * (1 + data_length_));
+    return ph_->syncWriteStage(start_address_, data_length_, param_, param_.size());
 }
 
 }  // namespace st3215
@@ -0,0 +1,351 @@
+#include "st3215/motion_queue.h"
+#include <algorithm>
+#include <cmath>
+
+namespace st3215 {
+
+namespace {
+
+double direction(const double from, const double to) {
+    return (to >= from) ? 1.0 : -1.0;
+}
+
+}  // namespace
+
+MotionQueue::MotionQueue(ProtocolPacketHandler* ph, double rate_hz)
+    : ph_(ph),
+      period_(1.0 / (rate_hz > 0.0 ? rate_hz : 100.0)),
+      sync_write_(ph, STS_GOAL_POSITION_L, 6),
+      record_(6, 0) {
+}
+
+bool MotionQueue::addServo(uint8_t sts_id, uint16_t start_position, double max_speed, double max_acc) {
+    if (axes_.find(sts_id) != axes_.end()) {
+        return false;
+    }
+
+    if (max_speed <= 0.0 || max_acc <= 0.0) {
+        return false;
+    }
+
+    Axis axis;
+    axis.max_speed = std::min(max_speed, static_cast<double>(MAX_SPEED));
+    axis.max_acc = max_acc;
+    axis.setpoint = std::min(start_position, MAX_POSITION);
+    axis.velocity = 0.0;
+    axis.needs_send = false;
+    axes_[sts_id] = axis;
+    return true;
+}
+
+void MotionQueue::removeServo(uint8_t sts_id) {
+    axes_.erase(sts_id);
+}
+
+bool MotionQueue::push(uint8_t sts_id, uint16_t position) {
+    auto it = axes_.find(sts_id);
+    if (it == axes_.end()) {
+        return false;
+    }
+
+    Axis& axis = it->second;
+    double start = axis.segments.empty() ? axis.setpoint : axis.segments.back().target;
+    double target = std::min(position, MAX_POSITION);
+    if (std::abs(target - start) < 0.5) {
+        return true;
+    }
+
+    Segment seg = {};
+    seg.start = start;
+    seg.target = target;
+    seg.t_start = -1.0;
+    axis.segments.push_back(seg);
+
+    replan(axis, now());
+    return true;
+}
+
+bool MotionQueue::push(const std::map<uint8_t, uint16_t>& waypoint) {
+    for (const auto& [sts_id, position] : waypoint) {
+        if (axes_.find(sts_id) == axes_.end()) {
+            return false;
+        }
+    }
+
+    for (const auto& [sts_id, position] : waypoint) {
+        push(sts_id, position);
+    }
+    return true;
+}
+
+void MotionQueue::clear() {
+    double t = now();
+
+    for (auto& [sts_id, axis] : axes_) {
+        double position = axis.setpoint;
+        double velocity = 0.0;
+        if (!axis.segments.empty() && axis.segments.front().t_start >= 0.0) {
+            sample(axis.segments.front(), t, position, velocity);
+        }
+        axis.segments.clear();
+        axis.setpoint = position;
+        axis.velocity = velocity;
+
+        if (velocity == 0.0) {
+            continue;
+        }
+
+        // Stop at the acceleration limit from the current state
+        double speed = std::abs(velocity);
+        double stop_distance = (speed * speed) / (2.0 * axis.max_acc);
+        double target = position + std::copysign(stop_distance, velocity);
+        target = std::clamp(target, static_cast<double>(MIN_POSITION), static_cast<double>(MAX_POSITION));
+
+        Segment seg = {};
+        seg.start = position;
+        seg.target = target;
+        seg.v_entry = speed;
+        seg.v_exit = 0.0;
+        seg.t_start = t;
+        profile(axis, seg);
+        axis.segments.push_back(seg);
+        axis.needs_send = true;
+    }
+}
+
+bool MotionQueue::isIdle() const {
+    for (const auto& [sts_id, axis] : axes_) {
+        if (!axis.segments.empty() || axis.needs_send) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t MotionQueue::pending(uint8_t sts_id) const {
+    auto it = axes_.find(sts_id);
+    if (it == axes_.end()) {
+        return 0;
+    }
+    return it->second.segments.size();
+}
+
+std::optional<double> MotionQueue::getSetpoint(uint8_t sts_id) const {
+    auto it = axes_.find(sts_id);
+    if (it == axes_.end()) {
+        return std::nullopt;
+    }
+    return it->second.setpoint;
+}
+
+int MotionQueue::tick() {
+    double t = now();
+
+    sync_write_.clearParam();
+    bool has_param = false;
+
+    for (auto& [sts_id, axis] : axes_) {
+        advance(axis, t);
+        if (!axis.needs_send) {
+            continue;
+        }
+
+        long position = std::lround(axis.setpoint);
+        position = std::clamp(position, static_cast<long>(MIN_POSITION), static_cast<long>(MAX_POSITION));
+        long speed = std::min(std::lround(std::abs(axis.velocity)), static_cast<long>(MAX_SPEED));
+        if (speed == 0) {
+            // Zero would lift the servo's speed limit; close the gap at the axis limit instead
+            speed = std::max(std::lround(axis.max_speed), 1L);
+        }
+
+        record_[0] = ph_->lobyte(static_cast<uint16_t>(position));
+        record_[1] = ph_->hibyte(static_cast<uint16_t>(position));
+        record_[4] = ph_->lobyte(static_cast<uint16_t>(speed));
+        record_[5] = ph_->hibyte(static_cast<uint16_t>(speed));
+        sync_write_.addParam(sts_id, record_);
+        axis.needs_send = false;
+        has_param = true;
+    }
+
+    if (!has_param) {
+        return COMM_SUCCESS;
+    }
+    return sync_write_.txPacket();
+}
+
+int MotionQueue::run() {
+    Clock* clock = ph_->getPortHandler()->getClock();
+    double next = clock->now();
+
+    while (!isIdle()) {
+        int result = tick();
+        if (result != COMM_SUCCESS) {
+            return result;
+        }
+        next += period_ * 1000.0;
+        clock->sleepUntil(next);
+    }
+
+    return COMM_SUCCESS;
+}
+
+double MotionQueue::now() const {
+    return ph_->getPortHandler()->getClock()->now() / 1000.0;
+}
+
+void MotionQueue::replan(Axis& axis, double t) {
+    auto& segments = axis.segments;
+    if (segments.empty()) {
+        return;
+    }
+
+    // Restart the active segment from the current state so that its exit
+    // speed can be raised to blend into the newly queued waypoints
+    double position = axis.setpoint;
+    double velocity = axis.velocity;
+    bool active = segments.front().t_start >= 0.0;
+    if (active) {
+        sample(segments.front(), t, position, velocity);
+        segments.front().start = position;
+        while (!segments.empty() && std::abs(segments.front().target - segments.front().start) < 1e-9) {
+            segments.pop_front();
+            if (!segments.empty()) {
+                segments.front().start = position;
+            }
+        }
+        if (segments.empty()) {
+            return;
+        }
+        segments.front().t_start = t;
+    }
+
+    const Segment& front = segments.front();
+    double v_now = std::max(0.0, velocity * direction(front.start, front.target));
+
+    // Backward pass: every segment must be able to slow down to the exit
+    // speed of the segment after it, ending at rest on the last waypoint
+    double v_exit = 0.0;
+    for (size_t i = segments.size(); i-- > 0;) {
+        Segment& seg = segments[i];
+        double distance = std::abs(seg.target - seg.start);
+        seg.v_exit = v_exit;
+
+        double v_entry = std::sqrt(v_exit * v_exit + 2.0 * axis.max_acc * distance);
+        if (i == 0) {
+            seg.v_entry = v_now;
+        } else {
+            const Segment& prev = segments[i - 1];
+            bool same_direction = direction(prev.start, prev.target) == direction(seg.start, seg.target);
+            v_entry = same_direction ? std::min(v_entry, axis.max_speed) : 0.0;
+            seg.v_entry = v_entry;
+        }
+        v_exit = seg.v_entry;
+    }
+
+    // Forward pass: limit each exit speed to what is reachable from the entry
+    for (size_t i = 0; i < segments.size(); ++i) {
+        Segment& seg = segments[i];
+        double distance = std::abs(seg.target - seg.start);
+        double reachable = std::sqrt(seg.v_entry * seg.v_entry + 2.0 * axis.max_acc * distance);
+        seg.v_exit = std::min(seg.v_exit, reachable);
+        if (i + 1 < segments.size()) {
+            segments[i + 1].v_entry = seg.v_exit;
+        }
+        profile(axis, seg);
+    }
+}
+
+void MotionQueue::profile(const Axis& axis, Segment& seg) const {
+    double distance = std::abs(seg.target - seg.start);
+    double a = axis.max_acc;
+    double v0 = seg.v_entry;
+    double v1 = seg.v_exit;
+
+    if (v0 * v0 - v1 * v1 >= 2.0 * a * distance) {
+        // Entry speed too high to slow down at the nominal rate, brake harder
+        seg.v_cruise = v0;
+        seg.t_acc = 0.0;
+        seg.t_cruise = 0.0;
+        seg.dec = (distance > 0.0) ? (v0 * v0 - v1 * v1) / (2.0 * distance) : 0.0;
+        seg.t_dec = (seg.dec > 0.0) ? (v0 - v1) / seg.dec : 0.0;
+        return;
+    }
+
+    double vc = std::sqrt(a * distance + 0.5 * (v0 * v0 + v1 * v1));
+    vc = std::max(std::min(vc, axis.max_speed), std::max(v0, v1));
+
+    double d_acc = (vc * vc - v0 * v0) / (2.0 * a);
+    double d_dec = (vc * vc - v1 * v1) / (2.0 * a);
+    double d_cruise = std::max(0.0, distance - d_acc - d_dec);
+
+    seg.v_cruise = vc;
+    seg.dec = a;
+    seg.t_acc = (vc - v0) / a;
+    seg.t_dec = (vc - v1) / a;
+    seg.t_cruise = (vc > 0.0) ? d_cruise / vc : 0.0;
+}
+
+void MotionQueue::sample(const Segment& seg, double t, double& position, double& velocity) const {
+    double dir = direction(seg.start, seg.target);
+    double distance = std::abs(seg.target - seg.start);
+    double tau = std::max(0.0, t - seg.t_start);
+
+    double d_acc = 0.5 * (seg.v_entry + seg.v_cruise) * seg.t_acc;
+    double d_cruise = seg.v_cruise * seg.t_cruise;
+    double s;
+    double v;
+
+    if (tau < seg.t_acc) {
+        double acc = (seg.v_cruise - seg.v_entry) / seg.t_acc;
+        s = seg.v_entry * tau + 0.5 * acc * tau * tau;
+        v = seg.v_entry + acc * tau;
+    } else if (tau < seg.t_acc + seg.t_cruise) {
+        s = d_acc + seg.v_cruise * (tau - seg.t_acc);
+        v = seg.v_cruise;
+    } else if (tau < seg.t_acc + seg.t_cruise + seg.t_dec) {
+        double u = tau - seg.t_acc - seg.t_cruise;
+        s = d_acc + d_cruise + seg.v_cruise * u - 0.5 * seg.dec * u * u;
+        v = seg.v_cruise - seg.dec * u;
+    } else {
+        s = distance;
+        v = seg.v_exit;
+    }
+
+    position = seg.start + dir * std::min(s, distance);
+    velocity = dir * v;
+}
+
+void MotionQueue::advance(Axis& axis, double t) {
+    bool finished = false;
+
+    while (!axis.segments.empty()) {
+        Segment& front = axis.segments.front();
+        if (front.t_start < 0.0) {
+            front.t_start = t;
+        }
+
+        double t_end = front.t_start + front.t_acc + front.t_cruise + front.t_dec;
+        if (t < t_end) {
+            break;
+        }
+
+        axis.setpoint = front.target;
+        axis.velocity = 0.0;
+        axis.segments.pop_front();
+        finished = true;
+
+        // Keep the timeline continuous across waypoints
+        if (!axis.segments.empty()) {
+            axis.segments.front().t_start = t_end;
+        }
+    }
+
+    if (!axis.segments.empty()) {
+        sample(axis.segments.front(), t, axis.setpoint, axis.velocity);
+        axis.needs_send = true;
+    } else if (finished) {
+        axis.needs_send = true;
+    }
+}
+
+}  // namespace st3215
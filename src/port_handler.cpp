@@ -17,6 +17,7 @@ PortHandler::PortHandler(const std::string& port_name)
       tx_time_per_byte_(0.0),
       is_using_(false),
       port_name_(port_name),
+      clock_(SystemClock::instance()),
       serial_fd_(-1) {
 }
 
@@ -120,9 +121,11 @@ bool PortHandler::isPacketTimeout() {
 }
 
 double PortHandler::getCurrentTime() {
-    auto now = std::chrono::high_resolution_clock::now();
-    auto duration = now.time_since_epoch();
-    return std::chrono::duration<double, std::milli>(duration).count();
+    return clock_->now();
+}
+
+void PortHandler::setClock(Clock* clock) {
+    clock_ = (clock != nullptr) ? clock : SystemClock::instance();
 }
 
 double PortHandler::getTimeSinceStart() {
@@ -0,0 +1,272 @@
+#include "st3215/protocol_engine.h"
+#include "trace.h"
+#include <algorithm>
+#include <utility>
+
+namespace st3215 {
+
+ProtocolEngine::ProtocolEngine()
+    : state_(State::IDLE),
+      expect_reply_(false),
+      tx_id_(0),
+      tx_instruction_(0),
+      reply_length_(0),
+      wait_length_(0),
+      staged_length_(0),
+      tx_time_per_byte_(0.0),
+      sent_time_(0.0),
+      timeout_(0.0),
+      completion_{} {
+}
+
+std::vector<uint8_t> ProtocolEngine::makePacket(uint8_t sts_id, uint8_t instruction,
+                                                const std::vector<uint8_t>& params) {
+    std::vector<uint8_t> txpacket(params.size() + 6, 0);
+    txpacket[PKT_ID] = sts_id;
+    txpacket[PKT_LENGTH] = static_cast<uint8_t>(params.size() + 2);
+    txpacket[PKT_INSTRUCTION] = instruction;
+    std::copy(params.begin(), params.end(), txpacket.begin() + PKT_PARAMETER0);
+    return txpacket;
+}
+
+size_t ProtocolEngine::finalize(std::vector<uint8_t>& txpacket) const {
+    if (txpacket.size() <= PKT_LENGTH) {
+        return 0;
+    }
+
+    size_t total_packet_length = txpacket[PKT_LENGTH] + 4;  // 4: HEADER0 HEADER1 ID LENGTH
+    if (total_packet_length > TXPACKET_MAX_LEN || total_packet_length > txpacket.size()) {
+        return 0;
+    }
+
+    // Make packet header and checksum
+    txpacket[PKT_HEADER_0] = 0xFF;
+    txpacket[PKT_HEADER_1] = 0xFF;
+    uint8_t checksum = 0;
+    for (size_t idx = 2; idx < total_packet_length - 1; ++idx) {
+        checksum += txpacket[idx];
+    }
+    txpacket[total_packet_length - 1] = ~checksum & 0xFF;
+    return total_packet_length;
+}
+
+int ProtocolEngine::submit(std::vector<uint8_t>& txpacket, bool expect_reply) {
+    if (state_ != State::IDLE) {
+        return COMM_PORT_BUSY;
+    }
+
+    size_t total_packet_length = finalize(txpacket);
+    if (total_packet_length == 0) {
+        return COMM_TX_ERROR;
+    }
+
+    tx_id_ = txpacket[PKT_ID];
+    tx_instruction_ = txpacket[PKT_INSTRUCTION];
+    output_.assign(staged_.begin(), staged_.end());
+    output_.insert(output_.end(), txpacket.begin(), txpacket.begin() + total_packet_length);
+    staged_length_ = staged_.size();
+    staged_.clear();
+    rx_buffer_.clear();
+    completion_.error = 0;
+
+    if (tx_instruction_ == INST_SYNC_READ && expect_reply) {
+        // One status packet per listed ID: HEADER0 HEADER1 ID LENGTH ERROR DATA... CHKSUM
+        size_t id_count = txpacket[PKT_LENGTH] - 4;
+        reply_length_ = (6 + txpacket[PKT_PARAMETER0 + 1]) * id_count;
+        wait_length_ = reply_length_;
+        expect_reply_ = true;
+    } else if (expect_reply && tx_id_ != BROADCAST_ID) {
+        reply_length_ = (tx_instruction_ == INST_READ) ? txpacket[PKT_PARAMETER0 + 1] + 6 : 6;
+        wait_length_ = 6;  // Minimum length (HEADER0 HEADER1 ID LENGTH ERROR CHKSUM)
+        expect_reply_ = true;
+    } else {
+        reply_length_ = 0;
+        wait_length_ = 0;
+        expect_reply_ = false;
+    }
+
+    state_ = State::SENDING;
+    return COMM_SUCCESS;
+}
+
+int ProtocolEngine::stage(std::vector<uint8_t>& txpacket) {
+    if (state_ != State::IDLE) {
+        return COMM_PORT_BUSY;
+    }
+
+    size_t total_packet_length = finalize(txpacket);
+    if (total_packet_length == 0 || txpacket[PKT_ID] != BROADCAST_ID) {
+        return COMM_TX_ERROR;
+    }
+
+    staged_.insert(staged_.end(), txpacket.begin(), txpacket.begin() + total_packet_length);
+    return COMM_SUCCESS;
+}
+
+std::vector<uint8_t> ProtocolEngine::takeOutput(double now) {
+    std::vector<uint8_t> output;
+    takeOutput(now, output);
+    return output;
+}
+
+void ProtocolEngine::takeOutput(double now, std::vector<uint8_t>& output) {
+    output.clear();
+    if (state_ != State::SENDING) {
+        return;
+    }
+
+    output.swap(output_);
+    sent_time_ = now;
+    ST3215_TRACE3(txrx_start, tx_id_, tx_instruction_, output.size());
+
+    if (!expect_reply_) {
+        complete(COMM_SUCCESS, now);
+    } else {
+        timeout_ = (tx_time_per_byte_ * (reply_length_ + staged_length_)) + (tx_time_per_byte_ * 3.0) + LATENCY_TIMER;
+        state_ = (tx_instruction_ == INST_SYNC_READ) ? State::AWAIT_SYNC_READ : State::AWAIT_STATUS;
+    }
+}
+
+void ProtocolEngine::receive(const uint8_t* data, size_t length, double now) {
+    if (state_ != State::AWAIT_STATUS && state_ != State::AWAIT_SYNC_READ) {
+        return;
+    }
+
+    rx_buffer_.insert(rx_buffer_.end(), data, data + length);
+
+    if (state_ == State::AWAIT_SYNC_READ) {
+        if (rx_buffer_.size() >= wait_length_) {
+            rx_buffer_.resize(wait_length_);
+            complete(COMM_SUCCESS, now);
+        }
+        return;
+    }
+
+    parseStatus(now);
+}
+
+void ProtocolEngine::tick(double now) {
+    if (state_ != State::AWAIT_STATUS && state_ != State::AWAIT_SYNC_READ) {
+        return;
+    }
+
+    if (now >= sent_time_ + timeout_) {
+        uint8_t id = (state_ == State::AWAIT_SYNC_READ) ? BROADCAST_ID : tx_id_;
+        ST3215_TRACE3(timeout, id, rx_buffer_.size(), wait_length_);
+        complete(rx_buffer_.empty() ? COMM_RX_TIMEOUT : COMM_RX_CORRUPT, now);
+    }
+}
+
+std::optional<double> ProtocolEngine::deadline() const {
+    if (state_ != State::AWAIT_STATUS && state_ != State::AWAIT_SYNC_READ) {
+        return std::nullopt;
+    }
+    return sent_time_ + timeout_;
+}
+
+size_t ProtocolEngine::bytesWanted() const {
+    if (state_ != State::AWAIT_STATUS && state_ != State::AWAIT_SYNC_READ) {
+        return 0;
+    }
+    return (wait_length_ > rx_buffer_.size()) ? wait_length_ - rx_buffer_.size() : 1;
+}
+
+std::optional<Transaction> ProtocolEngine::poll() {
+    Transaction transaction{};
+    if (!poll(transaction)) {
+        return std::nullopt;
+    }
+    return transaction;
+}
+
+bool ProtocolEngine::poll(Transaction& transaction) {
+    if (state_ != State::DONE) {
+        return false;
+    }
+
+    state_ = State::IDLE;
+    std::swap(transaction, completion_);
+    return true;
+}
+
+void ProtocolEngine::cancel() {
+    state_ = State::IDLE;
+    output_.clear();
+    staged_.clear();
+    rx_buffer_.clear();
+}
+
+void ProtocolEngine::parseStatus(double now) {
+    while (rx_buffer_.size() >= wait_length_) {
+        // Find packet header
+        size_t idx;
+        for (idx = 0; idx < rx_buffer_.size() - 1; ++idx) {
+            if (rx_buffer_[idx] == 0xFF && rx_buffer_[idx + 1] == 0xFF) {
+                break;
+            }
+        }
+
+        if (idx != 0) {
+            // Remove unnecessary bytes before the header
+            rx_buffer_.erase(rx_buffer_.begin(), rx_buffer_.begin() + idx);
+            continue;
+        }
+
+        if ((rx_buffer_[PKT_ID] > 0xFD) || (rx_buffer_[PKT_LENGTH] > RXPACKET_MAX_LEN) ||
+            (rx_buffer_[PKT_ERROR] > 0x7F)) {
+            // Invalid packet, remove first byte
+            rx_buffer_.erase(rx_buffer_.begin());
+            continue;
+        }
+
+        // Re-calculate exact length
+        size_t frame_length = rx_buffer_[PKT_LENGTH] + PKT_LENGTH + 1;
+        if (wait_length_ != frame_length) {
+            wait_length_ = frame_length;
+            continue;
+        }
+
+        uint8_t checksum = 0;
+        for (size_t i = 2; i < frame_length - 1; ++i) {
+            checksum += rx_buffer_[i];
+        }
+        checksum = ~checksum & 0xFF;
+
+        if (rx_buffer_[frame_length - 1] != checksum) {
+            ST3215_TRACE3(checksum_fail, rx_buffer_[PKT_ID], checksum, rx_buffer_[frame_length - 1]);
+            rx_buffer_.resize(frame_length);
+            complete(COMM_RX_CORRUPT, now);
+            return;
+        }
+
+        ST3215_TRACE3(frame_parsed, rx_buffer_[PKT_ID], rx_buffer_[PKT_LENGTH], rx_buffer_[PKT_ERROR]);
+
+        if (rx_buffer_[PKT_ID] != tx_id_) {
+            // Status packet from another servo, keep waiting for ours
+            rx_buffer_.erase(rx_buffer_.begin(), rx_buffer_.begin() + frame_length);
+            wait_length_ = 6;
+            continue;
+        }
+
+        rx_buffer_.resize(frame_length);
+        completion_.error = rx_buffer_[PKT_ERROR];
+        complete(COMM_SUCCESS, now);
+        return;
+    }
+}
+
+void ProtocolEngine::complete(int result, double now) {
+    completion_.id = tx_id_;
+    completion_.instruction = tx_instruction_;
+    completion_.result = result;
+    completion_.rxpacket.swap(rx_buffer_);
+    rx_buffer_.clear();
+    completion_.latency = now - sent_time_;
+    state_ = State::DONE;
+
+    if (ST3215_TRACE_ENABLED(txrx_end)) {
+        ST3215_TRACE4(txrx_end, tx_id_, tx_instruction_, result, static_cast<uint64_t>(completion_.latency * 1000.0));
+    }
+}
+
+}  // namespace st3215
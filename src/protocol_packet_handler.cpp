@@ -1,12 +1,15 @@
 #include "st3215/protocol_packet_handler.h"
 #include <algorithm>
-#include <thread>
-#include <chrono>
+#include <utility>
 
 namespace st3215 {
 
 ProtocolPacketHandler::ProtocolPacketHandler(PortHandler* port_handler)
-    : port_handler_(port_handler), sts_end_(0) {
+    : port_handler_(port_handler), sts_end_(0), transaction_{} {
+    // Sized once for the largest packet so register access never allocates
+    tx_buffer_.reserve(TXPACKET_MAX_LEN);
+    output_.reserve(TXPACKET_MAX_LEN);
+    transaction_.rxpacket.reserve(RXPACKET_MAX_LEN);
 }
 
 std::string ProtocolPacketHandler::getTxRxResult(int result) const {
@@ -69,122 +72,125 @@ int16_t ProtocolPacketHandler::toHost(uint16_t a, uint8_t b) const {
     }
 }
 
-int ProtocolPacketHandler::txPacket(std::vector<uint8_t>& txpacket) {
-    uint8_t checksum = 0;
-    size_t total_packet_length = txpacket[PKT_LENGTH] + 4;  // 4: HEADER0 HEADER1 ID LENGTH
 
+int ProtocolPacketHandler::txPacket(std::vector<uint8_t>& txpacket, bool expect_reply) {
     if (port_handler_->isUsing()) {
+        engine_.clearStaged();
         return COMM_PORT_BUSY;
     }
     port_handler_->setUsing(true);
 
-    // Check max packet length
-    if (total_packet_length > TXPACKET_MAX_LEN) {
+    // Make packet header and checksum, and derive the expected reply
+    engine_.setTxTimePerByte(port_handler_->getTxTimePerByte());
+    int result = engine_.submit(txpacket, expect_reply);
+    if (result != COMM_SUCCESS) {
+        engine_.clearStaged();
         port_handler_->setUsing(false);
-        return COMM_TX_ERROR;
+        return result;
     }
 
-    // Make packet header
-    txpacket[PKT_HEADER_0] = 0xFF;
-    txpacket[PKT_HEADER_1] = 0xFF;
-
-    // Add checksum
-    for (size_t idx = 2; idx < total_packet_length - 1; ++idx) {
-        checksum += txpacket[idx];
-    }
-    txpacket[total_packet_length - 1] = ~checksum & 0xFF;
-
     // Transmit packet
     port_handler_->clearPort();
-    size_t written_packet_length = port_handler_->writePort(txpacket);
-    if (total_packet_length != written_packet_length) {
+    engine_.takeOutput(port_handler_->getCurrentTime(), output_);
+    size_t written_packet_length = port_handler_->writePort(output_);
+    if (output_.size() != written_packet_length) {
+        engine_.cancel();
         port_handler_->setUsing(false);
         return COMM_TX_FAIL;
     }
 
+    // Nothing to wait for: drop the completed transaction
+    if (!engine_.deadline()) {
+        engine_.poll(transaction_);
+        transaction_.rxpacket.clear();
+    }
+
     return COMM_SUCCESS;
 }
 
 std::tuple<std::vector<uint8_t>, int> ProtocolPacketHandler::rxPacket() {
-    std::vector<uint8_t> rxpacket;
-    int result = COMM_TX_FAIL;
-    uint8_t checksum = 0;
-    size_t rx_length = 0;
-    size_t wait_length = 6;  // Minimum length (HEADER0 HEADER1 ID LENGTH ERROR CHKSUM)
-
-    while (true) {
-        auto new_data = port_handler_->readPort(wait_length - rx_length);
-        rxpacket.insert(rxpacket.end(), new_data.begin(), new_data.end());
-        rx_length = rxpacket.size();
-
-        if (rx_length >= wait_length) {
-            // Find packet header
-            size_t idx;
-            for (idx = 0; idx < rx_length - 1; ++idx) {
-                if (rxpacket[idx] == 0xFF && rxpacket[idx + 1] == 0xFF) {
-                    break;
-                }
-            }
-
-            if (idx == 0) {  // Found at beginning
-                // Validate packet header before accessing
-                if (rx_length < 5) {
-                    continue;  // Need at least 5 bytes for valid packet
-                }
-                
-                if ((rxpacket[PKT_ID] > 0xFD) || (rxpacket[PKT_LENGTH] > RXPACKET_MAX_LEN) ||
-                    (rxpacket[PKT_ERROR] > 0x7F)) {
-                    // Invalid packet, remove first byte
-                    rxpacket.erase(rxpacket.begin());
-                    rx_length--;
-                    continue;
-                }
-
-                // Re-calculate exact length
-                if (wait_length != static_cast<size_t>(rxpacket[PKT_LENGTH] + PKT_LENGTH + 1)) {
-                    wait_length = rxpacket[PKT_LENGTH] + PKT_LENGTH + 1;
-                    continue;
-                }
-
-                if (rx_length < wait_length) {
-                    // Check timeout
-                    if (port_handler_->isPacketTimeout()) {
-                        result = (rx_length == 0) ? COMM_RX_TIMEOUT : COMM_RX_CORRUPT;
-                        break;
-                    }
-                    continue;
-                }
-
-                // Calculate checksum
-                for (size_t i = 2; i < wait_length - 1; ++i) {
-                    checksum += rxpacket[i];
-                }
-                checksum = ~checksum & 0xFF;
-
-                // Verify checksum
-                if (rxpacket[wait_length - 1] == checksum) {
-                    result = COMM_SUCCESS;
-                } else {
-                    result = COMM_RX_CORRUPT;
-                }
-                break;
-
-            } else {
-                // Remove unnecessary packets
-                rxpacket.erase(rxpacket.begin(), rxpacket.begin() + idx);
-                rx_length -= idx;
-            }
-        } else {
-            // Check timeout
-            if (port_handler_->isPacketTimeout()) {
-                result = (rx_length == 0) ? COMM_RX_TIMEOUT : COMM_RX_CORRUPT;
-                break;
-            }
+    int result = waitReply();
+    return std::make_tuple(std::move(transaction_.rxpacket), result);
+}
+
+int ProtocolPacketHandler::waitReply() {
+    // Feed the engine until the status packet is complete or times out
+    while (engine_.deadline()) {
+        auto new_data = port_handler_->readPort(engine_.bytesWanted());
+        double now = port_handler_->getCurrentTime();
+        if (!new_data.empty()) {
+            engine_.receive(new_data.data(), new_data.size(), now);
         }
+        engine_.tick(now);
     }
 
     port_handler_->setUsing(false);
-    return std::make_tuple(rxpacket, result);
+
+    if (!engine_.poll(transaction_)) {
+        transaction_.rxpacket.clear();
+        return COMM_RX_FAIL;
+    }
+    return transaction_.result;
+}
+
+uint8_t* ProtocolPacketHandler::preparePacket(uint8_t sts_id, uint8_t instruction, size_t param_length) {
+    tx_buffer_.assign(param_length + 6, 0);
+    tx_buffer_[PKT_ID] = sts_id;
+    // An oversized packet gets a length the engine rejects with
+    // COMM_TX_ERROR instead of a truncated one that would be sent
+    tx_buffer_[PKT_LENGTH] = (param_length + 6 > TXPACKET_MAX_LEN) ? 0xFF : static_cast<uint8_t>(param_length + 2);
+    tx_buffer_[PKT_INSTRUCTION] = instruction;
+    return tx_buffer_.data() + PKT_PARAMETER0;
+}
+
+int ProtocolPacketHandler::transact(bool expect_reply) {
+    int result = txPacket(tx_buffer_, expect_reply);
+    if (result != COMM_SUCCESS) {
+        return result;
+    }
+
+    if (!expect_reply || tx_buffer_[PKT_ID] == BROADCAST_ID) {
+        port_handler_->setUsing(false);
+        transaction_.rxpacket.clear();
+        return result;
+    }
+
+    return waitReply();
+}
+
+int ProtocolPacketHandler::readRegisters(uint8_t sts_id, uint8_t address, uint8_t length,
+                                         uint8_t* data, uint8_t& error) {
+    error = 0;
+    if (sts_id >= BROADCAST_ID) {
+        return COMM_NOT_AVAILABLE;
+    }
+
+    uint8_t* params = preparePacket(sts_id, INST_READ, 2);
+    params[0] = address;
+    params[1] = length;
+
+    int result = transact(true);
+    const std::vector<uint8_t>& rxpacket = transaction_.rxpacket;
+    if (result == COMM_SUCCESS) {
+        if (rxpacket.size() < static_cast<size_t>(PKT_PARAMETER0 + length)) {
+            return COMM_RX_CORRUPT;
+        }
+        error = rxpacket[PKT_ERROR];
+        std::copy_n(rxpacket.begin() + PKT_PARAMETER0, length, data);
+    }
+    return result;
+}
+
+int ProtocolPacketHandler::writeRegisters(uint8_t sts_id, uint8_t instruction, uint8_t address, uint8_t length,
+                                          const uint8_t* data, size_t data_size, bool expect_reply, uint8_t& error) {
+    uint8_t* params = preparePacket(sts_id, instruction, length + 1);
+    params[0] = address;
+    std::copy_n(data, std::min<size_t>(length, data_size), params + 1);
+
+    int result = transact(expect_reply);
+    const std::vector<uint8_t>& rxpacket = transaction_.rxpacket;
+    error = (result == COMM_SUCCESS && rxpacket.size() > PKT_ERROR) ? rxpacket[PKT_ERROR] : 0;
+    return result;
 }
 
 std::tuple<std::vector<uint8_t>, int, uint8_t> ProtocolPacketHandler::txRxPacket(std::vector<uint8_t>& txpacket) {
@@ -203,22 +209,10 @@ std::tuple<std::vector<uint8_t>, int, uint8_t> ProtocolPacketHandler::txRxPacket
         return std::make_tuple(rxpacket, result, error);
     }
 
-    // Set packet timeout
-    if (txpacket[PKT_INSTRUCTION] == INST_READ) {
-        port_handler_->setPacketTimeout(txpacket[PKT_PARAMETER0 + 1] + 6);
-    } else {
-        port_handler_->setPacketTimeout(6);
-    }
-
-    // Receive packet
-    while (true) {
-        std::tie(rxpacket, result) = rxPacket();
-        if (result != COMM_SUCCESS || (rxpacket.size() > PKT_ID && txpacket[PKT_ID] == rxpacket[PKT_ID])) {
-            break;
-        }
-    }
+    // Receive packet; status packets from other IDs are skipped by the engine
+    std::tie(rxpacket, result) = rxPacket();
 
-    if (result == COMM_SUCCESS && rxpacket.size() > PKT_ERROR && txpacket[PKT_ID] == rxpacket[PKT_ID]) {
+    if (result == COMM_SUCCESS && rxpacket.size() > PKT_ERROR) {
         error = rxpacket[PKT_ERROR];
     }
 
@@ -229,15 +223,11 @@ std::tuple<uint16_t, int, uint8_t> ProtocolPacketHandler::ping(uint8_t sts_id) {
     uint16_t model_number = 0;
     uint8_t error = 0;
 
-    std::vector<uint8_t> txpacket(6, 0);
-
     if (sts_id >= BROADCAST_ID) {
         return std::make_tuple(model_number, COMM_NOT_AVAILABLE, error);
     }
 
-    txpacket[PKT_ID] = sts_id;
-    txpacket[PKT_LENGTH] = 2;
-    txpacket[PKT_INSTRUCTION] = INST_PING;
+    std::vector<uint8_t> txpacket = ProtocolEngine::makePacket(sts_id, INST_PING, {});
 
     std::vector<uint8_t> rxpacket;
     int result;
@@ -255,132 +245,80 @@ std::tuple<uint16_t, int, uint8_t> ProtocolPacketHandler::ping(uint8_t sts_id) {
 }
 
 int ProtocolPacketHandler::action(uint8_t sts_id) {
-    std::vector<uint8_t> txpacket(6, 0);
-    txpacket[PKT_ID] = sts_id;
-    txpacket[PKT_LENGTH] = 2;
-    txpacket[PKT_INSTRUCTION] = INST_ACTION;
-
-    std::vector<uint8_t> rxpacket;
-    int result;
-    uint8_t error;
-    std::tie(rxpacket, result, error) = txRxPacket(txpacket);
-
-    return result;
+    preparePacket(sts_id, INST_ACTION, 0);
+    return transact(true);
 }
 
 std::tuple<std::vector<uint8_t>, int, uint8_t> ProtocolPacketHandler::readTxRx(uint8_t sts_id, uint8_t address, uint8_t length) {
-    std::vector<uint8_t> data;
-    std::vector<uint8_t> txpacket(8, 0);
-
-    if (sts_id >= BROADCAST_ID) {
-        return std::make_tuple(data, COMM_NOT_AVAILABLE, 0);
-    }
-
-    txpacket[PKT_ID] = sts_id;
-    txpacket[PKT_LENGTH] = 4;
-    txpacket[PKT_INSTRUCTION] = INST_READ;
-    txpacket[PKT_PARAMETER0 + 0] = address;
-    txpacket[PKT_PARAMETER0 + 1] = length;
-
-    std::vector<uint8_t> rxpacket;
-    int result;
+    std::vector<uint8_t> data(length);
     uint8_t error;
-    std::tie(rxpacket, result, error) = txRxPacket(txpacket);
-
-    if (result == COMM_SUCCESS && rxpacket.size() >= static_cast<size_t>(PKT_PARAMETER0 + length)) {
-        error = rxpacket[PKT_ERROR];
-        data.insert(data.end(), rxpacket.begin() + PKT_PARAMETER0, rxpacket.begin() + PKT_PARAMETER0 + length);
+    int result = readRegisters(sts_id, address, length, data.data(), error);
+    if (result != COMM_SUCCESS) {
+        data.clear();
     }
-
     return std::make_tuple(data, result, error);
 }
 
 std::tuple<uint8_t, int, uint8_t> ProtocolPacketHandler::read1ByteTxRx(uint8_t sts_id, uint8_t address) {
-    std::vector<uint8_t> data;
-    int result;
+    uint8_t data[1] = {0};
     uint8_t error;
-    std::tie(data, result, error) = readTxRx(sts_id, address, 1);
-    uint8_t data_read = (result == COMM_SUCCESS && !data.empty()) ? data[0] : 0;
+    int result = readRegisters(sts_id, address, 1, data, error);
+    uint8_t data_read = (result == COMM_SUCCESS) ? data[0] : 0;
     return std::make_tuple(data_read, result, error);
 }
 
 std::tuple<uint16_t, int, uint8_t> ProtocolPacketHandler::read2ByteTxRx(uint8_t sts_id, uint8_t address) {
-    std::vector<uint8_t> data;
-    int result;
+    uint8_t data[2] = {0, 0};
     uint8_t error;
-    std::tie(data, result, error) = readTxRx(sts_id, address, 2);
-    uint16_t data_read = (result == COMM_SUCCESS && data.size() >= 2) ? makeWord(data[0], data[1]) : 0;
+    int result = readRegisters(sts_id, address, 2, data, error);
+    uint16_t data_read = (result == COMM_SUCCESS) ? makeWord(data[0], data[1]) : 0;
     return std::make_tuple(data_read, result, error);
 }
 
 std::tuple<uint32_t, int, uint8_t> ProtocolPacketHandler::read4ByteTxRx(uint8_t sts_id, uint8_t address) {
-    std::vector<uint8_t> data;
-    int result;
+    uint8_t data[4] = {0, 0, 0, 0};
     uint8_t error;
-    std::tie(data, result, error) = readTxRx(sts_id, address, 4);
+    int result = readRegisters(sts_id, address, 4, data, error);
     uint32_t data_read = 0;
-    if (result == COMM_SUCCESS && data.size() >= 4) {
+    if (result == COMM_SUCCESS) {
         data_read = makeDWord(makeWord(data[0], data[1]), makeWord(data[2], data[3]));
     }
     return std::make_tuple(data_read, result, error);
 }
 
 int ProtocolPacketHandler::writeTxOnly(uint8_t sts_id, uint8_t address, uint8_t length, const std::vector<uint8_t>& data) {
-    std::vector<uint8_t> txpacket(length + 7, 0);
-
-    txpacket[PKT_ID] = sts_id;
-    txpacket[PKT_LENGTH] = length + 3;
-    txpacket[PKT_INSTRUCTION] = INST_WRITE;
-    txpacket[PKT_PARAMETER0] = address;
-
-    for (uint8_t i = 0; i < length; ++i) {
-        txpacket[PKT_PARAMETER0 + 1 + i] = data[i];
-    }
-
-    int result = txPacket(txpacket);
-    port_handler_->setUsing(false);
-
-    return result;
+    uint8_t error;
+    return writeRegisters(sts_id, INST_WRITE, address, length, data.data(), data.size(), false, error);
 }
 
 std::tuple<int, uint8_t> ProtocolPacketHandler::writeTxRx(uint8_t sts_id, uint8_t address, uint8_t length, const std::vector<uint8_t>& data) {
-    std::vector<uint8_t> txpacket(length + 7, 0);
-
-    txpacket[PKT_ID] = sts_id;
-    txpacket[PKT_LENGTH] = length + 3;
-    txpacket[PKT_INSTRUCTION] = INST_WRITE;
-    txpacket[PKT_PARAMETER0] = address;
-
-    for (uint8_t i = 0; i < length; ++i) {
-        txpacket[PKT_PARAMETER0 + 1 + i] = data[i];
-    }
-
-    std::vector<uint8_t> rxpacket;
-    int result;
     uint8_t error;
-    std::tie(rxpacket, result, error) = txRxPacket(txpacket);
-
+    int result = writeRegisters(sts_id, INST_WRITE, address, length, data.data(), data.size(), true, error);
     return std::make_tuple(result, error);
 }
 
 int ProtocolPacketHandler::write1ByteTxOnly(uint8_t sts_id, uint8_t address, uint8_t data) {
-    std::vector<uint8_t> data_write = {data};
-    return writeTxOnly(sts_id, address, 1, data_write);
+    uint8_t error;
+    return writeRegisters(sts_id, INST_WRITE, address, 1, &data, 1, false, error);
 }
 
 std::tuple<int, uint8_t> ProtocolPacketHandler::write1ByteTxRx(uint8_t sts_id, uint8_t address, uint8_t data) {
-    std::vector<uint8_t> data_write = {data};
-    return writeTxRx(sts_id, address, 1, data_write);
+    uint8_t error;
+    int result = writeRegisters(sts_id, INST_WRITE, address, 1, &data, 1, true, error);
+    return std::make_tuple(result, error);
 }
 
 int ProtocolPacketHandler::write2ByteTxOnly(uint8_t sts_id, uint8_t address, uint16_t data) {
-    std::vector<uint8_t> data_write = {lobyte(data), hibyte(data)};
-    return writeTxOnly(sts_id, address, 2, data_write);
+    const uint8_t data_write[2] = {lobyte(data), hibyte(data)};
+    uint8_t error;
+    return writeRegisters(sts_id, INST_WRITE, address, 2, data_write, 2, false, error);
 }
 
 std::tuple<int, uint8_t> ProtocolPacketHandler::write2ByteTxRx(uint8_t sts_id, uint8_t address, uint16_t data) {
-    std::vector<uint8_t> data_write = {lobyte(data), hibyte(data)};
-    return writeTxRx(sts_id, address, 2, data_write);
+    const uint8_t data_write[2] = {lobyte(data), hibyte(data)};
+    uint8_t error;
+    int result = writeRegisters(sts_id, INST_WRITE, address, 2, data_write, 2, true, error);
+    return std::make_tuple(result, error);
 }
 
 int16_t ProtocolPacketHandler::toScs(int16_t a, uint8_t b) const {
@@ -400,25 +338,14 @@ uint16_t ProtocolPacketHandler::hiword(uint32_t h) const {
 }
 
 int ProtocolPacketHandler::readTx(uint8_t sts_id, uint8_t address, uint8_t length) {
-    std::vector<uint8_t> txpacket(8, 0);
-
     if (sts_id >= BROADCAST_ID) {
         return COMM_NOT_AVAILABLE;
     }
 
-    txpacket[PKT_ID] = sts_id;
-    txpacket[PKT_LENGTH] = 4;
-    txpacket[PKT_INSTRUCTION] = INST_READ;
-    txpacket[PKT_PARAMETER0 + 0] = address;
-    txpacket[PKT_PARAMETER0 + 1] = length;
-
-    int result = txPacket(txpacket);
-
-    if (result == COMM_SUCCESS) {
-        port_handler_->setPacketTimeout(length + 6);
-    }
-
-    return result;
+    uint8_t* params = preparePacket(sts_id, INST_READ, 2);
+    params[0] = address;
+    params[1] = length;
+    return txPacket(tx_buffer_);
 }
 
 std::tuple<std::vector<uint8_t>, int, uint8_t> ProtocolPacketHandler::readRx(uint8_t sts_id, uint8_t length) {
@@ -427,12 +354,7 @@ std::tuple<std::vector<uint8_t>, int, uint8_t> ProtocolPacketHandler::readRx(uin
     std::vector<uint8_t> data;
     std::vector<uint8_t> rxpacket;
 
-    while (true) {
-        std::tie(rxpacket, result) = rxPacket();
-        if (result != COMM_SUCCESS || (rxpacket.size() > PKT_ID && rxpacket[PKT_ID] == sts_id)) {
-            break;
-        }
-    }
+    std::tie(rxpacket, result) = rxPacket();
 
     if (result == COMM_SUCCESS && rxpacket.size() > PKT_ID && rxpacket[PKT_ID] == sts_id) {
         error = rxpacket[PKT_ERROR];
@@ -478,126 +400,79 @@ std::tuple<uint32_t, int, uint8_t> ProtocolPacketHandler::read4ByteRx(uint8_t st
 }
 
 int ProtocolPacketHandler::write4ByteTxOnly(uint8_t sts_id, uint8_t address, uint32_t data) {
-    std::vector<uint8_t> data_write = {
+    const uint8_t data_write[4] = {
         lobyte(loword(data)), hibyte(loword(data)),
         lobyte(hiword(data)), hibyte(hiword(data))
     };
-    return writeTxOnly(sts_id, address, 4, data_write);
+    uint8_t error;
+    return writeRegisters(sts_id, INST_WRITE, address, 4, data_write, 4, false, error);
 }
 
 std::tuple<int, uint8_t> ProtocolPacketHandler::write4ByteTxRx(uint8_t sts_id, uint8_t address, uint32_t data) {
-    std::vector<uint8_t> data_write = {
+    const uint8_t data_write[4] = {
         lobyte(loword(data)), hibyte(loword(data)),
         lobyte(hiword(data)), hibyte(hiword(data))
     };
-    return writeTxRx(sts_id, address, 4, data_write);
+    uint8_t error;
+    int result = writeRegisters(sts_id, INST_WRITE, address, 4, data_write, 4, true, error);
+    return std::make_tuple(result, error);
 }
 
 int ProtocolPacketHandler::regWriteTxOnly(uint8_t sts_id, uint8_t address, uint8_t length, const std::vector<uint8_t>& data) {
-    std::vector<uint8_t> txpacket(length + 7, 0);
-
-    txpacket[PKT_ID] = sts_id;
-    txpacket[PKT_LENGTH] = length + 3;
-    txpacket[PKT_INSTRUCTION] = INST_REG_WRITE;
-    txpacket[PKT_PARAMETER0] = address;
-
-    for (uint8_t i = 0; i < length; ++i) {
-        txpacket[PKT_PARAMETER0 + 1 + i] = data[i];
-    }
-
-    int result = txPacket(txpacket);
-    port_handler_->setUsing(false);
-
-    return result;
+    uint8_t error;
+    return writeRegisters(sts_id, INST_REG_WRITE, address, length, data.data(), data.size(), false, error);
 }
 
 std::tuple<int, uint8_t> ProtocolPacketHandler::regWriteTxRx(uint8_t sts_id, uint8_t address, uint8_t length, const std::vector<uint8_t>& data) {
-    std::vector<uint8_t> txpacket(length + 7, 0);
-
-    txpacket[PKT_ID] = sts_id;
-    txpacket[PKT_LENGTH] = length + 3;
-    txpacket[PKT_INSTRUCTION] = INST_REG_WRITE;
-    txpacket[PKT_PARAMETER0] = address;
-
-    for (uint8_t i = 0; i < length; ++i) {
-        txpacket[PKT_PARAMETER0 + 1 + i] = data[i];
-    }
-
-    std::vector<uint8_t> rxpacket;
-    int result;
     uint8_t error;
-    std::tie(rxpacket, result, error) = txRxPacket(txpacket);
-
+    int result = writeRegisters(sts_id, INST_REG_WRITE, address, length, data.data(), data.size(), true, error);
     return std::make_tuple(result, error);
 }
 
 int ProtocolPacketHandler::syncReadTx(uint8_t start_address, uint8_t data_length, const std::vector<uint8_t>& param, size_t param_length) {
-    std::vector<uint8_t> txpacket(param_length + 8, 0);
-
-    txpacket[PKT_ID] = BROADCAST_ID;
-    txpacket[PKT_LENGTH] = static_cast<uint8_t>(param_length + 4);
-    txpacket[PKT_INSTRUCTION] = INST_SYNC_READ;
-    txpacket[PKT_PARAMETER0 + 0] = start_address;
-    txpacket[PKT_PARAMETER0 + 1] = data_length;
-
-    for (size_t i = 0; i < param_length && i < param.size(); ++i) {
-        txpacket[PKT_PARAMETER0 + 2 + i] = param[i];
-    }
+    uint8_t* params = preparePacket(BROADCAST_ID, INST_SYNC_READ, param_length + 2);
+    params[0] = start_address;
+    params[1] = data_length;
+    std::copy_n(param.begin(), std::min(param_length, param.size()), params + 2);
 
-    int result = txPacket(txpacket);
-    return result;
+    return txPacket(tx_buffer_);
 }
 
 std::tuple<int, std::vector<uint8_t>> ProtocolPacketHandler::syncReadRx(uint8_t data_length, size_t param_length) {
-    size_t wait_length = (6 + data_length) * param_length;
-    port_handler_->setPacketTimeout(wait_length);
     std::vector<uint8_t> rxpacket;
-    size_t rx_length = 0;
-    int result;
+    int result = syncReadRx(data_length, param_length, rxpacket);
+    return std::make_tuple(result, std::move(rxpacket));
+}
 
-    while (true) {
-        auto new_data = port_handler_->readPort(wait_length - rx_length);
-        rxpacket.insert(rxpacket.end(), new_data.begin(), new_data.end());
-        rx_length = rxpacket.size();
-
-        if (rx_length >= wait_length) {
-            result = COMM_SUCCESS;
-            break;
-        } else {
-            if (port_handler_->isPacketTimeout()) {
-                if (rx_length == 0) {
-                    result = COMM_RX_TIMEOUT;
-                } else {
-                    result = COMM_RX_CORRUPT;
-                }
-                break;
-            }
-        }
-    }
+int ProtocolPacketHandler::syncReadRx(uint8_t data_length, size_t param_length, std::vector<uint8_t>& rxpacket) {
+    // The expected reply length was derived from the sync read packet;
+    // the arguments only guard against a mismatched call
+    int result = waitReply();
+    rxpacket.swap(transaction_.rxpacket);
+    transaction_.rxpacket.clear();
 
-    port_handler_->setUsing(false);
-    return std::make_tuple(result, rxpacket);
+    if (result == COMM_SUCCESS && rxpacket.size() != (6 + data_length) * param_length) {
+        result = COMM_RX_CORRUPT;
+    }
+    return result;
 }
 
 int ProtocolPacketHandler::syncWriteTxOnly(uint8_t start_address, uint8_t data_length, const std::vector<uint8_t>& param, size_t param_length) {
-    std::vector<uint8_t> txpacket(param_length + 8, 0);
+    uint8_t* params = preparePacket(BROADCAST_ID, INST_SYNC_WRITE, param_length + 2);
+    params[0] = start_address;
+    params[1] = data_length;
+    std::copy_n(param.begin(), std::min(param_length, param.size()), params + 2);
 
-    txpacket[PKT_ID] = BROADCAST_ID;
-    txpacket[PKT_LENGTH] = static_cast<uint8_t>(param_length + 4);
-    txpacket[PKT_INSTRUCTION] = INST_SYNC_WRITE;
-    txpacket[PKT_PARAMETER0 + 0] = start_address;
-    txpacket[PKT_PARAMETER0 + 1] = data_length;
+    return transact(false);
+}
 
-    for (size_t i = 0; i < param_length && i < param.size(); ++i) {
-        txpacket[PKT_PARAMETER0 + 2 + i] = param[i];
-    }
+int ProtocolPacketHandler::syncWriteStage(uint8_t start_address, uint8_t data_length, const std::vector<uint8_t>& param, size_t param_length) {
+    uint8_t* params = preparePacket(BROADCAST_ID, INST_SYNC_WRITE, param_length + 2);
+    params[0] = start_address;
+    params[1] = data_length;
+    std::copy_n(param.begin(), std::min(param_length, param.size()), params + 2);
 
-    std::vector<uint8_t> rxpacket;
-    int result;
-    uint8_t error;
-    std::tie(rxpacket, result, error) = txRxPacket(txpacket);
-
-    return result;
+    return engine_.stage(tx_buffer_);
 }
 
 }  // namespace st3215
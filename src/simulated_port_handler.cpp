@@ -0,0 +1,409 @@
+#include "st3215/simulated_port_handler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace st3215 {
+
+namespace {
+
+constexpr uint16_t SIM_MODEL_NUMBER = 777;
+
+uint16_t word(const std::array<uint8_t, 256>& regs, uint8_t address) {
+    return static_cast<uint16_t>(regs[address] | (regs[address + 1] << 8));
+}
+
+void setWord(std::array<uint8_t, 256>& regs, uint8_t address, uint16_t value) {
+    regs[address] = value & 0xFF;
+    regs[address + 1] = (value >> 8) & 0xFF;
+}
+
+}  // namespace
+
+SimulatedPortHandler::SimulatedPortHandler(Clock* clock)
+    : PortHandler("simulated"),
+      bus_free_at_(0.0),
+      bus_time_(0.0),
+      tx_bytes_(0),
+      write_count_(0),
+      rx_bytes_(0) {
+    setClock(clock);
+}
+
+bool SimulatedPortHandler::openPort() {
+    is_open_ = true;
+    tx_time_per_byte_ = (1000.0 / baudrate_) * 10.0;
+    return true;
+}
+
+void SimulatedPortHandler::closePort() {
+    is_open_ = false;
+}
+
+void SimulatedPortHandler::clearPort() {
+    tx_buffer_.clear();
+    rx_buffer_.clear();
+}
+
+bool SimulatedPortHandler::setBaudRate(uint32_t baudrate) {
+    baudrate_ = baudrate;
+    if (is_open_) {
+        tx_time_per_byte_ = (1000.0 / baudrate_) * 10.0;
+    }
+    return true;
+}
+
+size_t SimulatedPortHandler::getBytesAvailable() {
+    double now = clock_->now();
+    size_t count = 0;
+    while (count < rx_buffer_.size() && rx_buffer_[count].arrival <= now) {
+        count++;
+    }
+    return count;
+}
+
+std::vector<uint8_t> SimulatedPortHandler::readPort(size_t length) {
+    std::vector<uint8_t> buffer;
+    if (!is_open_ || length == 0) {
+        return buffer;
+    }
+
+    // Nothing has arrived yet: wait for the next byte, or one byte time if
+    // nothing is on its way, so polling loops make progress in virtual time
+    double now = clock_->now();
+    if (rx_buffer_.empty()) {
+        clock_->sleepFor(tx_time_per_byte_);
+        return buffer;
+    }
+    if (rx_buffer_.front().arrival > now) {
+        clock_->sleepUntil(rx_buffer_.front().arrival);
+        now = clock_->now();
+    }
+
+    buffer.reserve(std::min(length, rx_buffer_.size()));
+    while (buffer.size() < length && !rx_buffer_.empty() && rx_buffer_.front().arrival <= now) {
+        buffer.push_back(rx_buffer_.front().value);
+        rx_buffer_.pop_front();
+    }
+    return buffer;
+}
+
+size_t SimulatedPortHandler::writePort(const std::vector<uint8_t>& packet) {
+    if (!is_open_ || packet.empty()) {
+        return 0;
+    }
+
+    double tx_start = std::max(clock_->now(), bus_free_at_);
+    size_t previous_size = tx_buffer_.size();
+    tx_buffer_.insert(tx_buffer_.end(), packet.begin(), packet.end());
+    tx_bytes_ += packet.size();
+    write_count_++;
+    bus_time_ += packet.size() * tx_time_per_byte_;
+    bus_free_at_ = tx_start + packet.size() * tx_time_per_byte_;
+
+    // Handle every complete instruction packet, timestamped at its last byte
+    size_t consumed = 0;
+    while (tx_buffer_.size() >= 6) {
+        if (tx_buffer_[0] != 0xFF || tx_buffer_[1] != 0xFF) {
+            tx_buffer_.erase(tx_buffer_.begin());
+            consumed++;
+            continue;
+        }
+
+        size_t total_length = tx_buffer_[PKT_LENGTH] + 4;
+        if (tx_buffer_.size() < total_length) {
+            break;
+        }
+
+        uint8_t checksum = 0;
+        for (size_t i = 2; i < total_length - 1; ++i) {
+            checksum += tx_buffer_[i];
+        }
+        if ((~checksum & 0xFF) != tx_buffer_[total_length - 1]) {
+            tx_buffer_.erase(tx_buffer_.begin());
+            consumed++;
+            continue;
+        }
+
+        std::vector<uint8_t> instruction(tx_buffer_.begin(), tx_buffer_.begin() + total_length);
+        tx_buffer_.erase(tx_buffer_.begin(), tx_buffer_.begin() + total_length);
+        consumed += total_length;
+
+        size_t end_offset = (consumed > previous_size) ? consumed - previous_size : 0;
+        handlePacket(instruction, tx_start + end_offset * tx_time_per_byte_);
+    }
+
+    return packet.size();
+}
+
+bool SimulatedPortHandler::addServo(uint8_t sts_id, uint16_t position) {
+    if (sts_id >= BROADCAST_ID || servos_.find(sts_id) != servos_.end()) {
+        return false;
+    }
+
+    Servo servo;
+    servo.regs.fill(0);
+    setWord(servo.regs, STS_MODEL_L, SIM_MODEL_NUMBER);
+    servo.regs[STS_ID] = sts_id;
+    servo.regs[STS_BAUD_RATE] = STS_1M;
+    servo.regs[STS_RETURN_DELAY_TIME] = 0;
+    setWord(servo.regs, STS_MIN_ANGLE_LIMIT_L, MIN_POSITION);
+    setWord(servo.regs, STS_MAX_ANGLE_LIMIT_L, MAX_POSITION);
+    setWord(servo.regs, STS_GOAL_POSITION_L, std::min(position, MAX_POSITION));
+    servo.regs[STS_LOCK] = 1;
+    setWord(servo.regs, STS_PRESENT_POSITION_L, std::min(position, MAX_POSITION));
+    servo.regs[STS_PRESENT_VOLTAGE] = 120;
+    servo.regs[STS_PRESENT_TEMPERATURE] = 30;
+    servo.position = std::min(position, MAX_POSITION);
+    servo.time_speed = 0.0;
+    servo.last_update = clock_->now();
+    servo.min_stop = MIN_POSITION;
+    servo.max_stop = MAX_POSITION;
+
+    servos_[sts_id] = servo;
+    return true;
+}
+
+void SimulatedPortHandler::removeServo(uint8_t sts_id) {
+    servos_.erase(sts_id);
+}
+
+bool SimulatedPortHandler::setStops(uint8_t sts_id, uint16_t min_stop, uint16_t max_stop) {
+    auto it = servos_.find(sts_id);
+    if (it == servos_.end()) {
+        return false;
+    }
+    it->second.min_stop = std::min(min_stop, max_stop);
+    it->second.max_stop = std::max(min_stop, max_stop);
+    return true;
+}
+
+std::optional<uint8_t> SimulatedPortHandler::getRegister(uint8_t sts_id, uint8_t address) {
+    auto it = servos_.find(sts_id);
+    if (it == servos_.end()) {
+        return std::nullopt;
+    }
+    update(it->second, clock_->now());
+    return it->second.regs[address];
+}
+
+bool SimulatedPortHandler::setRegister(uint8_t sts_id, uint8_t address, uint8_t value) {
+    auto it = servos_.find(sts_id);
+    if (it == servos_.end()) {
+        return false;
+    }
+    it->second.regs[address] = value;
+    return true;
+}
+
+void SimulatedPortHandler::handlePacket(const std::vector<uint8_t>& packet, double tx_end) {
+    uint8_t sts_id = packet[PKT_ID];
+    uint8_t instruction = packet[PKT_INSTRUCTION];
+    const uint8_t* params = packet.data() + PKT_PARAMETER0;
+    size_t param_length = packet[PKT_LENGTH] - 2;
+
+    for (auto& [id, servo] : servos_) {
+        update(servo, tx_end);
+    }
+
+    auto target = servos_.find(sts_id);
+    bool addressed = (target != servos_.end());
+
+    switch (instruction) {
+        case INST_PING:
+            if (addressed) {
+                reply(sts_id, nullptr, 0, tx_end);
+            }
+            break;
+
+        case INST_READ:
+            if (addressed && param_length >= 2) {
+                uint8_t address = params[0];
+                size_t length = std::min<size_t>(params[1], 256 - address);
+                reply(sts_id, target->second.regs.data() + address, length, tx_end);
+            }
+            break;
+
+        case INST_WRITE:
+        case INST_REG_WRITE:
+            if (param_length < 1) {
+                break;
+            }
+            for (auto& [id, servo] : servos_) {
+                if (id != sts_id && sts_id != BROADCAST_ID) {
+                    continue;
+                }
+                if (instruction == INST_WRITE) {
+                    writeRegisters(id, servo, params[0], params + 1, param_length - 1);
+                } else {
+                    servo.reg_write.assign(params, params + param_length);
+                }
+            }
+            if (addressed) {
+                reply(sts_id, nullptr, 0, tx_end);
+            }
+            break;
+
+        case INST_ACTION:
+            for (auto& [id, servo] : servos_) {
+                if ((id == sts_id || sts_id == BROADCAST_ID) && !servo.reg_write.empty()) {
+                    writeRegisters(id, servo, servo.reg_write[0], servo.reg_write.data() + 1,
+                                   servo.reg_write.size() - 1);
+                    servo.reg_write.clear();
+                }
+            }
+            if (addressed) {
+                reply(sts_id, nullptr, 0, tx_end);
+            }
+            break;
+
+        case INST_SYNC_WRITE:
+            if (param_length >= 2) {
+                uint8_t address = params[0];
+                size_t length = params[1];
+                for (size_t i = 2; i + 1 + length <= param_length; i += 1 + length) {
+                    auto it = servos_.find(params[i]);
+                    if (it != servos_.end()) {
+                        writeRegisters(it->first, it->second, address, params + i + 1, length);
+                    }
+                }
+            }
+            break;
+
+        case INST_SYNC_READ:
+            if (param_length >= 2) {
+                uint8_t address = params[0];
+                size_t length = std::min<size_t>(params[1], 256 - address);
+                double start = tx_end;
+                for (size_t i = 2; i < param_length; ++i) {
+                    auto it = servos_.find(params[i]);
+                    if (it != servos_.end()) {
+                        start = reply(it->first, it->second.regs.data() + address, length, start);
+                    }
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    // Apply ID changes after the reply so the status comes from the old ID
+    for (auto it = servos_.begin(); it != servos_.end();) {
+        uint8_t new_id = it->second.regs[STS_ID];
+        if (new_id != it->first && new_id < BROADCAST_ID && servos_.find(new_id) == servos_.end()) {
+            servos_[new_id] = it->second;
+            it = servos_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SimulatedPortHandler::writeRegisters(uint8_t sts_id, Servo& servo, uint8_t address, const uint8_t* data,
+                                          size_t length) {
+    (void)sts_id;
+    bool goal_written = false;
+
+    for (size_t i = 0; i < length && address + i < 256; ++i) {
+        size_t reg = address + i;
+        // Model number and present-state registers are read-only
+        if (reg <= STS_MODEL_H || reg >= STS_PRESENT_POSITION_L) {
+            continue;
+        }
+        servo.regs[reg] = data[i];
+        if (reg >= STS_GOAL_POSITION_L && reg <= STS_GOAL_SPEED_H) {
+            goal_written = true;
+        }
+    }
+
+    if (servo.regs[STS_TORQUE_ENABLE] == 128) {
+        // Torque value 128 recalibrates the current position as the middle
+        servo.position = 2048;
+        setWord(servo.regs, STS_PRESENT_POSITION_L, 2048);
+        setWord(servo.regs, STS_GOAL_POSITION_L, 2048);
+        servo.regs[STS_TORQUE_ENABLE] = 0;
+    }
+
+    if (goal_written) {
+        servo.regs[STS_TORQUE_ENABLE] = 1;
+        uint16_t goal = std::min(word(servo.regs, STS_GOAL_POSITION_L), MAX_POSITION);
+        uint16_t goal_time = word(servo.regs, STS_GOAL_TIME_L);
+        servo.time_speed = (goal_time > 0) ? std::abs(goal - servo.position) * 1000.0 / goal_time : 0.0;
+    }
+}
+
+void SimulatedPortHandler::update(Servo& servo, double now) {
+    double dt = (now - servo.last_update) / 1000.0;
+    if (dt <= 0.0) {
+        return;
+    }
+    servo.last_update = now;
+
+    double velocity = 0.0;
+    bool moving = false;
+
+    if (servo.regs[STS_TORQUE_ENABLE] == 1) {
+        uint16_t speed_raw = word(servo.regs, STS_GOAL_SPEED_L);
+        double speed = speed_raw & 0x7FFF;
+
+        if (servo.regs[STS_MODE] == 0) {
+            double goal = std::min(word(servo.regs, STS_GOAL_POSITION_L), MAX_POSITION);
+            if (servo.time_speed > 0.0) {
+                speed = servo.time_speed;
+            } else if (speed == 0.0) {
+                speed = MAX_SPEED;
+            }
+
+            double diff = goal - servo.position;
+            double step = speed * dt;
+            if (std::abs(diff) <= step) {
+                servo.position = goal;
+            } else {
+                velocity = std::copysign(speed, diff);
+                servo.position += velocity * dt;
+            }
+            moving = servo.position != goal;
+        } else if (servo.regs[STS_MODE] == 1) {
+            velocity = (speed_raw & 0x8000) ? -speed : speed;
+            servo.position += velocity * dt;
+            if (servo.position <= servo.min_stop || servo.position >= servo.max_stop) {
+                servo.position = std::clamp(servo.position, static_cast<double>(servo.min_stop),
+                                            static_cast<double>(servo.max_stop));
+                velocity = 0.0;
+            }
+            moving = velocity != 0.0;
+        }
+    }
+
+    uint16_t speed_magnitude = static_cast<uint16_t>(std::min(std::lround(std::abs(velocity)), 0x7FFFL));
+    setWord(servo.regs, STS_PRESENT_POSITION_L, static_cast<uint16_t>(std::lround(servo.position)));
+    setWord(servo.regs, STS_PRESENT_SPEED_L, speed_magnitude | (velocity < 0.0 ? 0x8000 : 0));
+    servo.regs[STS_MOVING] = moving ? 1 : 0;
+}
+
+double SimulatedPortHandler::reply(uint8_t sts_id, const uint8_t* params, size_t length, double start) {
+    const Servo& servo = servos_[sts_id];
+
+    std::vector<uint8_t> frame = {0xFF, 0xFF, sts_id, static_cast<uint8_t>(length + 2), 0};
+    frame.insert(frame.end(), params, params + length);
+    uint8_t checksum = 0;
+    for (size_t i = 2; i < frame.size(); ++i) {
+        checksum += frame[i];
+    }
+    frame.push_back(~checksum & 0xFF);
+
+    // Return delay register is in units of 2 us
+    double return_delay = servo.regs[STS_RETURN_DELAY_TIME] * 0.002;
+    double frame_start = std::max(start, bus_free_at_) + return_delay;
+    for (size_t i = 0; i < frame.size(); ++i) {
+        rx_buffer_.push_back({frame_start + (i + 1) * tx_time_per_byte_, frame[i]});
+    }
+
+    double frame_end = frame_start + frame.size() * tx_time_per_byte_;
+    bus_time_ += return_delay + frame.size() * tx_time_per_byte_;
+    rx_bytes_ += frame.size();
+    bus_free_at_ = frame_end;
+    return frame_end;
+}
+
+}  // namespace st3215
@@ -1,23 +1,74 @@
 #include "st3215/st3215.h"
-#include <thread>
-#include <chrono>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <stdexcept>
 
 namespace st3215 {
 
+namespace {
+
+// Constructors cannot report failure without exceptions
+[[noreturn]] void failOpen(const std::string& message) {
+#ifdef ST3215_EMBEDDED
+    (void)message;
+    std::abort();
+#else
+    throw std::runtime_error(message);
+#endif
+}
+
+}  // namespace
+
 ST3215::ST3215(const std::string& device)
     : ProtocolPacketHandler(nullptr),
       port_handler_(std::make_unique<PortHandler>(device)) {
     
     if (!port_handler_->openPort()) {
-        throw std::runtime_error("Could not open port: " + device);
+        failOpen("Could not open port: " + device);
     }
     
     // Update the base class to use our port handler
     ProtocolPacketHandler::port_handler_ = port_handler_.get();
 
     groupSyncWrite = std::make_unique<GroupSyncWrite>(this, STS_ACC, 7);
+    goal_sync_write_ = std::make_unique<GroupSyncWrite>(this, STS_GOAL_POSITION_L, 6);
+}
+
+ST3215::ST3215(std::unique_ptr<PortHandler> port_handler)
+    : ProtocolPacketHandler(nullptr),
+      port_handler_(std::move(port_handler)) {
+
+    if (!port_handler_) {
+        failOpen("No port handler given");
+    }
+
+    if (!port_handler_->openPort()) {
+        failOpen("Could not open port: " + port_handler_->getPortName());
+    }
+
+    ProtocolPacketHandler::port_handler_ = port_handler_.get();
+
+    groupSyncWrite = std::make_unique<GroupSyncWrite>(this, STS_ACC, 7);
+    goal_sync_write_ = std::make_unique<GroupSyncWrite>(this, STS_GOAL_POSITION_L, 6);
+}
+
+ST3215::ST3215(std::unique_ptr<PortHandler> port_handler, Opened)
+    : ProtocolPacketHandler(port_handler.get()),
+      port_handler_(std::move(port_handler)) {
+    groupSyncWrite = std::make_unique<GroupSyncWrite>(this, STS_ACC, 7);
+    goal_sync_write_ = std::make_unique<GroupSyncWrite>(this, STS_GOAL_POSITION_L, 6);
+}
+
+std::unique_ptr<ST3215> ST3215::open(const std::string& device) {
+    return open(std::make_unique<PortHandler>(device));
+}
+
+std::unique_ptr<ST3215> ST3215::open(std::unique_ptr<PortHandler> port_handler) {
+    if (!port_handler || !port_handler->openPort()) {
+        return nullptr;
+    }
+    return std::unique_ptr<ST3215>(new ST3215(std::move(port_handler), Opened{}));
 }
 
 ST3215::~ST3215() {
@@ -199,42 +250,32 @@ std::optional<std::map<std::string, bool>> ST3215::readStatus(uint8_t sts_id) {
 }
 
 bool ST3215::setAcceleration(uint8_t sts_id, uint8_t acc) {
-    std::vector<uint8_t> txpacket = {acc};
-    int comm;
-    uint8_t error;
-    std::tie(comm, error) = writeTxRx(sts_id, STS_ACC, 1, txpacket);
-    return (comm == COMM_SUCCESS && error == 0);
+    return writeOrBatch(sts_id, STS_ACC, &acc, 1);
 }
 
 bool ST3215::setSpeed(uint8_t sts_id, uint16_t speed) {
-    std::vector<uint8_t> txpacket = {lobyte(speed), hibyte(speed)};
-    int comm;
-    uint8_t error;
-    std::tie(comm, error) = writeTxRx(sts_id, STS_GOAL_SPEED_L, 2, txpacket);
-    return (comm == COMM_SUCCESS && error == 0);
+    uint8_t data[2] = {lobyte(speed), hibyte(speed)};
+    return writeOrBatch(sts_id, STS_GOAL_SPEED_L, data, 2);
 }
 
 bool ST3215::stopServo(uint8_t sts_id) {
-    std::vector<uint8_t> txpacket = {0};
     int comm;
     uint8_t error;
-    std::tie(comm, error) = writeTxRx(sts_id, STS_TORQUE_ENABLE, 1, txpacket);
+    std::tie(comm, error) = write1ByteTxRx(sts_id, STS_TORQUE_ENABLE, 0);
     return (comm == COMM_SUCCESS && error == 0);
 }
 
 bool ST3215::startServo(uint8_t sts_id) {
-    std::vector<uint8_t> txpacket = {1};
     int comm;
     uint8_t error;
-    std::tie(comm, error) = writeTxRx(sts_id, STS_TORQUE_ENABLE, 1, txpacket);
+    std::tie(comm, error) = write1ByteTxRx(sts_id, STS_TORQUE_ENABLE, 1);
     return (comm == COMM_SUCCESS && error == 0);
 }
 
 bool ST3215::setMode(uint8_t sts_id, uint8_t mode) {
-    std::vector<uint8_t> txpacket = {mode};
     int comm;
     uint8_t error;
-    std::tie(comm, error) = writeTxRx(sts_id, STS_MODE, 1, txpacket);
+    std::tie(comm, error) = write1ByteTxRx(sts_id, STS_MODE, mode);
     return (comm == COMM_SUCCESS && error == 0);
 }
 
@@ -244,16 +285,13 @@ bool ST3215::correctPosition(uint8_t sts_id, int16_t correction) {
         correction_magnitude = MAX_CORRECTION;
     }
     
-    std::vector<uint8_t> txpacket = {lobyte(correction_magnitude), hibyte(correction_magnitude)};
+    uint8_t txpacket[2] = {lobyte(correction_magnitude), hibyte(correction_magnitude)};
     
     if (correction < 0) {
         txpacket[1] |= (1 << 3);
     }
     
-    int comm;
-    uint8_t error;
-    std::tie(comm, error) = writeTxRx(sts_id, STS_OFS_L, 2, txpacket);
-    return (comm == COMM_SUCCESS && error == 0);
+    return writeOrBatch(sts_id, STS_OFS_L, txpacket, 2);
 }
 
 bool ST3215::rotate(uint8_t sts_id, int16_t speed) {
@@ -284,13 +322,24 @@ bool ST3215::moveTo(uint8_t sts_id, uint16_t position, uint16_t speed, uint8_t a
         acc = 1;  // Use minimum safe value
     }
     
-    if (!setMode(sts_id, 0) || !setAcceleration(sts_id, acc) || !setSpeed(sts_id, speed)) {
+    // Acceleration is written directly so moveTo() is never split by batching
+    int comm;
+    uint8_t error;
+    if (!setMode(sts_id, 0)) {
+        return false;
+    }
+    std::tie(comm, error) = write1ByteTxRx(sts_id, STS_ACC, acc);
+    if (comm != COMM_SUCCESS || error != 0) {
         return false;
     }
     
     auto curr_pos = readPosition(sts_id);
     
-    if (!writePosition(sts_id, position)) {
+    // Position, time and speed in one write; clearing the goal time left by
+    // moveInTime() lets the speed govern
+    uint8_t goal[6] = {lobyte(position), hibyte(position), 0, 0, lobyte(speed), hibyte(speed)};
+    comm = writeRegisters(sts_id, INST_WRITE, STS_GOAL_POSITION_L, 6, goal, 6, true, error);
+    if (comm != COMM_SUCCESS || error != 0) {
         return false;
     }
     
@@ -308,20 +357,144 @@ bool ST3215::moveTo(uint8_t sts_id, uint16_t position, uint16_t speed, uint8_t a
             time_wait = time_to_speed + (remain_distance / speed);
         }
         
-        std::this_thread::sleep_for(std::chrono::duration<double>(time_wait));
+        port_handler_->getClock()->sleepFor(time_wait * 1000.0);
     }
     
     return true;
 }
 
 bool ST3215::writePosition(uint8_t sts_id, uint16_t position) {
-    std::vector<uint8_t> txpacket = {lobyte(position), hibyte(position)};
-    int comm;
+    uint8_t data[2] = {lobyte(position), hibyte(position)};
+    return writeOrBatch(sts_id, STS_GOAL_POSITION_L, data, 2);
+}
+
+bool ST3215::moveInTime(uint8_t sts_id, uint16_t position, uint16_t time_ms, bool wait, uint16_t max_speed) {
+    if (position > MAX_POSITION) {
+        return false;
+    }
+
+    // [POS_L, POS_H, TIME_L, TIME_H, SPEED_L, SPEED_H]; zero speed lets the time govern
+    max_speed = std::min(max_speed, MAX_SPEED);
+    uint8_t goal[6] = {lobyte(position), hibyte(position), lobyte(time_ms), hibyte(time_ms),
+                       lobyte(max_speed), hibyte(max_speed)};
+
+    uint8_t error;
+    int comm = writeRegisters(sts_id, INST_WRITE, STS_GOAL_POSITION_L, 6, goal, 6, true, error);
+    if (comm != COMM_SUCCESS || error != 0) {
+        return false;
+    }
+
+    if (wait) {
+        port_handler_->getClock()->sleepFor(time_ms);
+    }
+    return true;
+}
+
+int ST3215::syncMoveInTime(const std::vector<TimedMove>& moves) {
+    goal_sync_write_->clearParam();
+    for (const TimedMove& move : moves) {
+        uint16_t speed = std::min(move.speed, MAX_SPEED);
+        if (move.position > MAX_POSITION ||
+            !goal_sync_write_->addParam(move.sts_id, {lobyte(move.position), hibyte(move.position),
+                                                      lobyte(move.time_ms), hibyte(move.time_ms),
+                                                      lobyte(speed), hibyte(speed)})) {
+            goal_sync_write_->clearParam();
+            return COMM_NOT_AVAILABLE;
+        }
+    }
+
+    int result = goal_sync_write_->txPacket();
+    goal_sync_write_->clearParam();
+    return result;
+}
+
+bool ST3215::writeOrBatch(uint8_t sts_id, uint8_t address, const uint8_t* data, uint8_t length) {
+    if (batching_ && sts_id < BROADCAST_ID) {
+        for (uint8_t i = 0; i < length; ++i) {
+            batch_.push_back({sts_id, static_cast<uint8_t>(address + i), data[i]});
+        }
+        return true;
+    }
+
     uint8_t error;
-    std::tie(comm, error) = writeTxRx(sts_id, STS_GOAL_POSITION_L, 2, txpacket);
+    int comm = writeRegisters(sts_id, INST_WRITE, address, length, data, length, true, error);
     return (comm == COMM_SUCCESS && error == 0);
 }
 
+int ST3215::flushBatch() {
+    batching_ = false;
+
+    // Order by servo and register; stable, so the last write to a register wins
+    std::stable_sort(batch_.begin(), batch_.end(), [](const BatchByte& a, const BatchByte& b) {
+        return (a.sts_id != b.sts_id) ? a.sts_id < b.sts_id : a.address < b.address;
+    });
+    size_t count = 0;
+    for (const BatchByte& byte : batch_) {
+        if (count > 0 && batch_[count - 1].sts_id == byte.sts_id && batch_[count - 1].address == byte.address) {
+            batch_[count - 1].value = byte.value;
+        } else {
+            batch_[count++] = byte;
+        }
+    }
+    batch_.resize(count);
+
+    // Merge each servo's registers into contiguous spans
+    batch_spans_.clear();
+    for (size_t i = 0; i < batch_.size(); ++i) {
+        if (batch_spans_.empty() || batch_spans_.back().sts_id != batch_[i].sts_id ||
+            batch_spans_.back().address + batch_spans_.back().length != batch_[i].address) {
+            batch_spans_.push_back({batch_[i].address, 0, batch_[i].sts_id, i});
+        }
+        batch_spans_.back().length++;
+    }
+
+    // One sync write per (address, length), records in ID order
+    std::sort(batch_spans_.begin(), batch_spans_.end(), [](const BatchSpan& a, const BatchSpan& b) {
+        if (a.address != b.address) {
+            return a.address < b.address;
+        }
+        return (a.length != b.length) ? a.length < b.length : a.sts_id < b.sts_id;
+    });
+
+    int result = COMM_SUCCESS;
+    size_t group = 0;
+    while (group < batch_spans_.size()) {
+        uint8_t address = batch_spans_[group].address;
+        uint8_t length = batch_spans_[group].length;
+        // FF FF ID LEN INST ADDR DLEN ... CHK around the records
+        size_t max_records = std::max<size_t>((TXPACKET_MAX_LEN - 8) / (length + 1), 1);
+
+        batch_param_.clear();
+        size_t records = 0;
+        size_t n = group;
+        for (; n < batch_spans_.size() && batch_spans_[n].address == address && batch_spans_[n].length == length; ++n) {
+            const BatchSpan& span = batch_spans_[n];
+            batch_param_.push_back(span.sts_id);
+            for (size_t k = 0; k < length; ++k) {
+                batch_param_.push_back(batch_[span.first + k].value);
+            }
+            if (++records == max_records) {
+                int sent = syncWriteTxOnly(address, length, batch_param_, batch_param_.size());
+                if (result == COMM_SUCCESS) {
+                    result = sent;
+                }
+                batch_param_.clear();
+                records = 0;
+            }
+        }
+        if (records > 0) {
+            int sent = syncWriteTxOnly(address, length, batch_param_, batch_param_.size());
+            if (result == COMM_SUCCESS) {
+                result = sent;
+            }
+        }
+        group = n;
+    }
+
+    batch_.clear();
+    return result;
+}
+
 int ST3215::lockEprom(uint8_t sts_id) {
     return write1ByteTxOnly(sts_id, STS_LOCK, 1);
 }
@@ -373,10 +546,9 @@ std::string ST3215::changeBaudrate(uint8_t sts_id, uint8_t new_baudrate) {
 }
 
 bool ST3215::defineMiddle(uint8_t sts_id) {
-    std::vector<uint8_t> txpacket = {128};
     int comm;
     uint8_t error;
-    std::tie(comm, error) = writeTxRx(sts_id, STS_TORQUE_ENABLE, 1, txpacket);
+    std::tie(comm, error) = write1ByteTxRx(sts_id, STS_TORQUE_ENABLE, 128);
     return (comm == COMM_SUCCESS && error == 0);
 }
 
@@ -408,7 +580,7 @@ std::optional<uint16_t> ST3215::getBlockPosition(uint8_t sts_id) {
             stop_matches = 0;
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        port_handler_->getClock()->sleepFor(20);
     }
 }
 
@@ -417,16 +589,16 @@ std::tuple<std::optional<uint16_t>, std::optional<uint16_t>> ST3215::tareServo(u
         return std::make_tuple(std::nullopt, std::nullopt);
     }
     
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    port_handler_->getClock()->sleepFor(500);
     
     setAcceleration(sts_id, 100);
     rotate(sts_id, -250);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    port_handler_->getClock()->sleepFor(500);
     
     auto min_position = getBlockPosition(sts_id);
     
     rotate(sts_id, 250);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    port_handler_->getClock()->sleepFor(500);
     
     auto max_position = getBlockPosition(sts_id);
     
@@ -453,7 +625,7 @@ std::tuple<std::optional<uint16_t>, std::optional<uint16_t>> ST3215::tareServo(u
         if (correctPosition(sts_id, correction_value)) {
             min_pos = 0;
             max_pos = distance * 2;
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            port_handler_->getClock()->sleepFor(500);
             
             moveTo(sts_id, distance);
         }
@@ -0,0 +1,56 @@
+#include "st3215/sync_cycle.h"
+#include <algorithm>
+
+namespace st3215 {
+
+SyncCycle::SyncCycle(ProtocolPacketHandler* ph, GroupSyncWrite* sync_write, GroupSyncRead* sync_read)
+    : ph_(ph), sync_write_(sync_write), sync_read_(sync_read), fused_(true) {
+}
+
+int SyncCycle::run() {
+    PortHandler* port = ph_->getPortHandler();
+    double start = port->getCurrentTime();
+
+    int result = fused_ ? runFused() : runSeparate();
+
+    double elapsed = port->getCurrentTime() - start;
+    stats_.cycles++;
+    if (result != COMM_SUCCESS) {
+        stats_.failed++;
+    }
+    stats_.last_time = elapsed;
+    stats_.mean_time += (elapsed - stats_.mean_time) / static_cast<double>(stats_.cycles);
+    stats_.max_time = std::max(stats_.max_time, elapsed);
+    return result;
+}
+
+int SyncCycle::runFused() {
+    int write_result = sync_write_->stagePacket();
+    if (write_result != COMM_SUCCESS && write_result != COMM_NOT_AVAILABLE) {
+        return write_result;
+    }
+
+    int result = sync_read_->txRxPacket();
+    if (result != COMM_NOT_AVAILABLE || write_result != COMM_SUCCESS) {
+        return result;
+    }
+
+    // Nothing to read: send the staged write on its own
+    ph_->clearStaged();
+    return sync_write_->txPacket();
+}
+
+int SyncCycle::runSeparate() {
+    int write_result = sync_write_->txPacket();
+    if (write_result != COMM_SUCCESS && write_result != COMM_NOT_AVAILABLE) {
+        return write_result;
+    }
+
+    int result = sync_read_->txRxPacket();
+    if (result == COMM_NOT_AVAILABLE && write_result == COMM_SUCCESS) {
+        return write_result;
+    }
+    return result;
+}
+
+}  // namespace st3215
@@ -0,0 +1,93 @@
+#include "st3215/sync_read_scanner.h"
+#include <cstring>
+
+namespace st3215 {
+
+namespace {
+
+// OR of all masked differences, compared eight bytes per step
+uint64_t maskedDiff(const uint8_t* __restrict__ data, const uint8_t* __restrict__ expected,
+                    const uint8_t* __restrict__ mask, size_t size) {
+    uint64_t diff = 0;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t d, e, m;
+        std::memcpy(&d, data + i, 8);
+        std::memcpy(&e, expected + i, 8);
+        std::memcpy(&m, mask + i, 8);
+        diff |= (d ^ e) & m;
+    }
+    for (; i < size; ++i) {
+        diff |= (data[i] ^ expected[i]) & mask[i];
+    }
+    return diff;
+}
+
+// Sum of bytes modulo 256, eight bytes per step in 16-bit lanes
+uint8_t byteSum(const uint8_t* data, size_t size) {
+    constexpr uint64_t LOW_BYTES = 0x00FF00FF00FF00FFULL;
+    uint64_t lanes = 0;
+    uint64_t word;
+
+    // Each step adds at most 510 per lane; frames are short enough not to overflow
+    for (; size >= 8; size -= 8, data += 8) {
+        std::memcpy(&word, data, 8);
+        lanes += (word & LOW_BYTES) + ((word >> 8) & LOW_BYTES);
+    }
+    if (size > 0) {
+        word = 0;
+        std::memcpy(&word, data, size);
+        lanes += (word & LOW_BYTES) + ((word >> 8) & LOW_BYTES);
+    }
+
+    // Add the four lanes into the top lane
+    return static_cast<uint8_t>((lanes * 0x0001000100010001ULL) >> 48);
+}
+
+}  // namespace
+
+SyncReadScanner::SyncReadScanner() : stride_(6), count_(0) {
+}
+
+void SyncReadScanner::reset(const std::vector<uint8_t>& ids, uint8_t data_length) {
+    stride_ = data_length + 6;
+    count_ = ids.size();
+    expected_.assign(stride_ * count_, 0);
+    mask_.assign(stride_ * count_, 0);
+
+    for (size_t k = 0; k < count_; ++k) {
+        uint8_t* expected = &expected_[k * stride_];
+        uint8_t* mask = &mask_[k * stride_];
+        expected[PKT_HEADER_0] = 0xFF;
+        expected[PKT_HEADER_1] = 0xFF;
+        expected[PKT_ID] = ids[k];
+        expected[PKT_LENGTH] = data_length + 2;
+        expected[PKT_ERROR] = 0;
+        mask[PKT_HEADER_0] = 0xFF;
+        mask[PKT_HEADER_1] = 0xFF;
+        mask[PKT_ID] = 0xFF;
+        mask[PKT_LENGTH] = 0xFF;
+        mask[PKT_ERROR] = 0x80;  // Error byte must be at most 0x7F
+    }
+}
+
+bool SyncReadScanner::scan(const std::vector<uint8_t>& rxpacket) const {
+    if (count_ == 0 || rxpacket.size() != expected_.size()) {
+        return false;
+    }
+
+    const uint8_t* data = rxpacket.data();
+    if (maskedDiff(data, expected_.data(), mask_.data(), expected_.size()) != 0) {
+        return false;
+    }
+
+    // Checksum covers ID LENGTH ERROR DATA...
+    uint8_t bad = 0;
+    for (size_t offset = 0; offset < expected_.size(); offset += stride_) {
+        uint8_t sum = byteSum(data + offset + PKT_ID, stride_ - 3);
+        bad |= static_cast<uint8_t>(~sum) ^ data[offset + stride_ - 1];
+    }
+    return bad == 0;
+}
+
+}  // namespace st3215
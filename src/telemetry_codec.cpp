@@ -0,0 +1,363 @@
+#include "st3215/telemetry_codec.h"
+#include <algorithm>
+#include <cstring>
+
+namespace st3215 {
+
+namespace {
+
+constexpr uint8_t MAGIC_0 = 'S';
+constexpr uint8_t MAGIC_1 = 'T';
+constexpr uint8_t VERSION = 1;
+
+// Leading values of each packed column stored as varints, so that absolute
+// start values do not widen the whole column:
+// TIME (timestamp, first interval), POSITION, SPEED, LOAD, CURRENT
+constexpr size_t HEAD[5] = {2, 1, 1, 1, 1};
+
+// Deltas wrap modulo 2^64 so extreme or corrupt values never overflow
+uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Packed columns are followed by zero padding so every value can be read
+// with whole 64-bit loads (two loads above 56 bits)
+size_t packedSize(size_t count, unsigned width) {
+    return (count * width + 7) / 8 + ((width > 56) ? 16 : 8);
+}
+
+void putWord(std::vector<uint8_t>& out, uint64_t word, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(word >> (8 * i)));
+    }
+}
+
+void packBits(std::vector<uint8_t>& out, const uint64_t* values, size_t count, unsigned width) {
+    size_t start = out.size();
+    uint64_t word = 0;
+    unsigned filled = 0;
+
+    if (width > 0) {
+        for (size_t n = 0; n < count; ++n) {
+            word |= values[n] << filled;
+            if (filled + width >= 64) {
+                putWord(out, word, 8);
+                word = (filled == 0) ? 0 : values[n] >> (64 - filled);
+                filled = filled + width - 64;
+            } else {
+                filled += width;
+            }
+        }
+        putWord(out, word, (filled + 7) / 8);
+    }
+
+    out.resize(start + packedSize(count, width), 0);
+}
+
+// Little-endian 64-bit load
+uint64_t load64(const uint8_t* p) {
+    uint64_t word;
+    std::memcpy(&word, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+uint64_t readBits(const uint8_t* p, size_t bit, unsigned width, uint64_t mask) {
+    unsigned shift = bit & 7;
+    uint64_t value = load64(p + (bit >> 3)) >> shift;
+    if (shift + width > 64) {
+        value |= load64(p + (bit >> 3) + 8) << (64 - shift);
+    }
+    return value & mask;
+}
+
+// Decoder cursor over one bit-packed column
+struct PackedColumn {
+    uint64_t head_values[2];
+    size_t head;
+    unsigned width;
+    uint64_t mask;
+    const uint8_t* bits;
+};
+
+// Decoder cursor over one run-length column
+struct RunColumn {
+    const uint8_t* p;
+    const uint8_t* end;
+    uint8_t value;
+    uint64_t remaining;
+};
+
+// Samples decoded per pass over the columns (8 KB of output)
+constexpr size_t DECODE_CHUNK = 256;
+
+}  // namespace
+
+TelemetryEncoder::TelemetryEncoder(size_t block_samples)
+    : block_samples_(std::min<size_t>(std::max<size_t>(block_samples, 1), MAX_BLOCK_SAMPLES)) {
+    for (auto& values : values_) {
+        values.reserve(block_samples_);
+    }
+    reset();
+}
+
+void TelemetryEncoder::reset() {
+    count_ = 0;
+    for (auto& values : values_) {
+        values.clear();
+    }
+    for (auto& runs : runs_) {
+        runs.clear();
+    }
+    last_timestamp_ = 0;
+    last_interval_ = 0;
+    last_value_.fill(0);
+    run_value_.fill(0);
+    run_length_.fill(0);
+}
+
+bool TelemetryEncoder::append(const TelemetrySample& sample) {
+    uint64_t interval = static_cast<uint64_t>(sample.timestamp) - last_timestamp_;
+    values_[0].push_back(zigzag(interval - last_interval_));
+    last_timestamp_ = static_cast<uint64_t>(sample.timestamp);
+    last_interval_ = interval;
+
+    const uint64_t values[4] = {
+        static_cast<uint64_t>(sample.position), static_cast<uint64_t>(sample.speed),
+        static_cast<uint64_t>(sample.load), static_cast<uint64_t>(sample.current)
+    };
+    for (size_t i = 0; i < 4; ++i) {
+        values_[1 + i].push_back(zigzag(values[i] - last_value_[i]));
+        last_value_[i] = values[i];
+    }
+
+    const uint8_t slow[2] = {sample.voltage, sample.temperature};
+    for (size_t i = 0; i < 2; ++i) {
+        if (run_length_[i] > 0 && slow[i] != run_value_[i]) {
+            endRun(i);
+        }
+        run_value_[i] = slow[i];
+        run_length_[i]++;
+    }
+
+    count_++;
+    return count_ >= block_samples_;
+}
+
+void TelemetryEncoder::endRun(size_t channel) {
+    runs_[channel].push_back(run_value_[channel]);
+    putVarint(runs_[channel], run_length_[channel]);
+    run_length_[channel] = 0;
+}
+
+std::vector<uint8_t> TelemetryEncoder::flush() {
+    std::vector<uint8_t> block;
+    if (count_ == 0) {
+        return block;
+    }
+
+    endRun(0);
+    endRun(1);
+
+    block.push_back(MAGIC_0);
+    block.push_back(MAGIC_1);
+    block.push_back(VERSION);
+    putVarint(block, count_);
+
+    for (size_t i = 0; i < values_.size(); ++i) {
+        const std::vector<uint64_t>& values = values_[i];
+        size_t head = std::min(HEAD[i], values.size());
+        for (size_t n = 0; n < head; ++n) {
+            putVarint(block, values[n]);
+        }
+
+        // Narrowest width that holds every remaining value
+        uint64_t bits = 0;
+        for (size_t n = head; n < values.size(); ++n) {
+            bits |= values[n];
+        }
+        unsigned width = 0;
+        while (width < 64 && (bits >> width) != 0) {
+            width++;
+        }
+
+        block.push_back(static_cast<uint8_t>(width));
+        packBits(block, values.data() + head, values.size() - head, width);
+    }
+
+    for (const auto& runs : runs_) {
+        putVarint(block, runs.size());
+        block.insert(block.end(), runs.begin(), runs.end());
+    }
+
+    reset();
+    return block;
+}
+
+size_t TelemetryDecoder::decodeBlock(const uint8_t* data, size_t size, std::vector<TelemetrySample>& samples) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+
+    if (size < 3 || p[0] != MAGIC_0 || p[1] != MAGIC_1 || p[2] != VERSION) {
+        return 0;
+    }
+    p += 3;
+
+    // Constant columns pack to zero bits, so the input size does not bound
+    // the sample count; the encoder never writes more than the maximum
+    uint64_t count;
+    if (!getVarint(p, end, count) || count == 0 || count > TelemetryEncoder::MAX_BLOCK_SAMPLES) {
+        return 0;
+    }
+
+    // Locate and validate every column before producing any samples
+    PackedColumn packed[5];
+    for (size_t i = 0; i < 5; ++i) {
+        PackedColumn& column = packed[i];
+        column.head = std::min<uint64_t>(HEAD[i], count);
+        for (size_t n = 0; n < column.head; ++n) {
+            if (!getVarint(p, end, column.head_values[n])) {
+                return 0;
+            }
+        }
+        if (p >= end || *p > 64) {
+            return 0;
+        }
+        column.width = *p++;
+        column.mask = (column.width == 64) ? ~0ULL : ((1ULL << column.width) - 1);
+        column.bits = p;
+        size_t bytes = packedSize(count - column.head, column.width);
+        if (bytes > static_cast<size_t>(end - p)) {
+            return 0;
+        }
+        p += bytes;
+    }
+
+    RunColumn runs[2];
+    for (RunColumn& column : runs) {
+        uint64_t length;
+        if (!getVarint(p, end, length) || length > static_cast<size_t>(end - p)) {
+            return 0;
+        }
+        column.p = p;
+        column.end = p + length;
+        column.remaining = 0;
+        p += length;
+    }
+
+    size_t first = samples.size();
+    samples.resize(first + count);
+    TelemetrySample* out = samples.data() + first;
+
+    int32_t TelemetrySample::* const fields[4] = {
+        &TelemetrySample::position, &TelemetrySample::speed, &TelemetrySample::load, &TelemetrySample::current
+    };
+    uint8_t TelemetrySample::* const slow[2] = {&TelemetrySample::voltage, &TelemetrySample::temperature};
+
+    // Timestamps are running sums of intervals, intervals of delta-of-deltas
+    uint64_t timestamp = 0;
+    uint64_t interval = 0;
+    uint64_t value[4] = {0, 0, 0, 0};
+
+    // Decode all columns one chunk at a time so the output stays in L1
+    for (size_t start = 0; start < count; start += DECODE_CHUNK) {
+        size_t stop = std::min<size_t>(start + DECODE_CHUNK, count);
+
+        const PackedColumn& time = packed[0];
+        for (size_t n = start; n < stop; ++n) {
+            uint64_t delta = (n < time.head) ? time.head_values[n]
+                : readBits(time.bits, (n - time.head) * time.width, time.width, time.mask);
+            interval += unzigzag(delta);
+            timestamp += interval;
+            out[n].timestamp = static_cast<int64_t>(timestamp);
+        }
+
+        for (size_t i = 0; i < 4; ++i) {
+            const PackedColumn& column = packed[1 + i];
+            int32_t TelemetrySample::* const field = fields[i];
+            uint64_t v = value[i];
+            size_t n = start;
+            for (; n < stop && n < column.head; ++n) {
+                v += unzigzag(column.head_values[n]);
+                out[n].*field = static_cast<int32_t>(v);
+            }
+            for (; n < stop; ++n) {
+                v += unzigzag(readBits(column.bits, (n - column.head) * column.width, column.width, column.mask));
+                out[n].*field = static_cast<int32_t>(v);
+            }
+            value[i] = v;
+        }
+
+        for (size_t i = 0; i < 2; ++i) {
+            RunColumn& column = runs[i];
+            for (size_t n = start; n < stop;) {
+                if (column.remaining == 0) {
+                    if (column.p >= column.end) {
+                        samples.resize(first);
+                        return 0;
+                    }
+                    column.value = *column.p++;
+                    if (!getVarint(column.p, column.end, column.remaining) || column.remaining == 0 ||
+                        column.remaining > count - n) {
+                        samples.resize(first);
+                        return 0;
+                    }
+                }
+                size_t fill = std::min<uint64_t>(column.remaining, stop - n);
+                for (size_t k = 0; k < fill; ++k) {
+                    out[n + k].*slow[i] = column.value;
+                }
+                n += fill;
+                column.remaining -= fill;
+            }
+        }
+    }
+
+    for (const RunColumn& column : runs) {
+        if (column.p != column.end) {
+            samples.resize(first);
+            return 0;
+        }
+    }
+    return p - data;
+}
+
+bool TelemetryDecoder::decode(const std::vector<uint8_t>& stream, std::vector<TelemetrySample>& samples) {
+    size_t offset = 0;
+    while (offset < stream.size()) {
+        size_t consumed = decodeBlock(stream.data() + offset, stream.size() - offset, samples);
+        if (consumed == 0) {
+            return false;
+        }
+        offset += consumed;
+    }
+    return true;
+}
+
+}  // namespace st3215
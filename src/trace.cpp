@@ -0,0 +1,18 @@
+#include "trace.h"
+
+#if defined(ST3215_HAVE_SDT)
+
+// Probe semaphores, incremented by the tracer when a probe is attached
+#define ST3215_DEFINE_SEMAPHORE(name) \
+    __attribute__((section(".probes"))) volatile unsigned short ST3215_TRACE_SEMAPHORE(name) = 0
+
+extern "C" {
+ST3215_DEFINE_SEMAPHORE(txrx_start);
+ST3215_DEFINE_SEMAPHORE(txrx_end);
+ST3215_DEFINE_SEMAPHORE(frame_parsed);
+ST3215_DEFINE_SEMAPHORE(checksum_fail);
+ST3215_DEFINE_SEMAPHORE(timeout);
+ST3215_DEFINE_SEMAPHORE(syncread_slot);
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef ST3215_TRACE_H
+#define ST3215_TRACE_H
+
+// Internal USDT tracepoints (provider "st3215").
+//
+// When built with ST3215_HAVE_SDT the probes are compiled in as sys/sdt.h
+// markers: a single nop per site, patched only when a tracer attaches.
+// Probes whose arguments cost something to compute check
+// ST3215_TRACE_ENABLED first, which reads the probe semaphore that the
+// tracer increments on attach. Without ST3215_HAVE_SDT everything expands
+// to nothing.
+//
+// Probes:
+//   txrx_start(id, instruction, tx_bytes)
+//   txrx_end(id, instruction, result, latency_us)
+//   frame_parsed(id, length, error)
+//   checksum_fail(id, expected, received)
+//   timeout(id, rx_bytes, expected_bytes)     id is 0xFE (BROADCAST_ID) for sync read
+//   syncread_slot(id, result)
+
+#if defined(ST3215_HAVE_SDT)
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define ST3215_TRACE_SEMAPHORE(name) st3215_##name##_semaphore
+
+extern "C" {
+extern volatile unsigned short ST3215_TRACE_SEMAPHORE(txrx_start);
+extern volatile unsigned short ST3215_TRACE_SEMAPHORE(txrx_end);
+extern volatile unsigned short ST3215_TRACE_SEMAPHORE(frame_parsed);
+extern volatile unsigned short ST3215_TRACE_SEMAPHORE(checksum_fail);
+extern volatile unsigned short ST3215_TRACE_SEMAPHORE(timeout);
+extern volatile unsigned short ST3215_TRACE_SEMAPHORE(syncread_slot);
+}
+
+#define ST3215_TRACE_ENABLED(name) __builtin_expect(ST3215_TRACE_SEMAPHORE(name) != 0, 0)
+#define ST3215_TRACE2(name, a, b) DTRACE_PROBE2(st3215, name, a, b)
+#define ST3215_TRACE3(name, a, b, c) DTRACE_PROBE3(st3215, name, a, b, c)
+#define ST3215_TRACE4(name, a, b, c, d) DTRACE_PROBE4(st3215, name, a, b, c, d)
+
+#else
+
+// Arguments are only named inside sizeof, so they are never evaluated
+#define ST3215_TRACE_ENABLED(name) false
+#define ST3215_TRACE2(name, a, b) do { (void)sizeof(a); (void)sizeof(b); } while (0)
+#define ST3215_TRACE3(name, a, b, c) do { (void)sizeof(a); (void)sizeof(b); (void)sizeof(c); } while (0)
+#define ST3215_TRACE4(name, a, b, c, d) \
+    do { (void)sizeof(a); (void)sizeof(b); (void)sizeof(c); (void)sizeof(d); } while (0)
+
+#endif
+
+#endif  // ST3215_TRACE_H
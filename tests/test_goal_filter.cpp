@@ -0,0 +1,76 @@
+#include "st3215/goal_filter.h"
+#include "st3215/st3215.h"
+#include "st3215/simulated_port_handler.h"
+#include "st3215/clock.h"
+#include <iostream>
+#include <memory>
+
+// Checks GoalFilter against simulated servos; exits non-zero on failure.
+
+namespace {
+
+bool check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "Check failed: " << what << std::endl;
+    }
+    return condition;
+}
+
+void setWord(st3215::SimulatedPortHandler* port, uint8_t sts_id, uint8_t address, uint16_t value) {
+    port->setRegister(sts_id, address, static_cast<uint8_t>(value & 0xFF));
+    port->setRegister(sts_id, address + 1, static_cast<uint8_t>(value >> 8));
+}
+
+}  // namespace
+
+int main() {
+    st3215::VirtualClock clock;
+    auto port = std::make_unique<st3215::SimulatedPortHandler>(&clock);
+    st3215::SimulatedPortHandler* bus = port.get();
+    bus->addServo(1);
+    bus->addServo(2);
+    setWord(bus, 1, st3215::STS_MIN_ANGLE_LIMIT_L, 100);
+    setWord(bus, 1, st3215::STS_MAX_ANGLE_LIMIT_L, 200);
+    st3215::ST3215 servo(std::move(port));
+    bool ok = true;
+
+    // Deadband is checked on the full distance, slew only limits the step
+    {
+        st3215::GoalFilter filter(&servo);
+        filter.addServo(1, 1000);
+        filter.setSlewLimit(1, 5);
+        filter.setDeadband(1, 10);
+        filter.setGoal(1, 2000);
+        ok = check(filter.apply() == 1 && filter.getFiltered(1) == 1005, "slew within deadband moves") && ok;
+        ok = check(filter.txPacket() == st3215::COMM_SUCCESS, "send slewed goal") && ok;
+        ok = check(filter.apply() == 1 && filter.getFiltered(1) == 1010, "slew continues from sent goal") && ok;
+        ok = check(filter.txPacket() == st3215::COMM_SUCCESS, "send second step") && ok;
+        filter.setGoal(1, 1020);
+        ok = check(filter.apply() == 0 && !filter.isChanged(1), "change within deadband is held") && ok;
+        filter.setGoal(1, 1021);
+        ok = check(filter.apply() == 1 && filter.getFiltered(1) == 1015, "change past deadband is slewed") && ok;
+    }
+
+    // Limits are clamped, and a missing servo does not stop the others loading
+    {
+        st3215::GoalFilter filter(&servo);
+        filter.addServo(1, 150);
+        filter.addServo(3, 150);  // Not on the bus
+        ok = check(filter.loadLimits() != st3215::COMM_SUCCESS, "missing servo reported") && ok;
+        filter.setGoal(1, 5000);
+        filter.apply();
+        ok = check(filter.getFiltered(1) == 200, "loaded limit clamps goal") && ok;
+
+        ok = check(filter.setLimits(3, 0, 9000), "set limits") && ok;
+        filter.setGoal(3, 9000);
+        filter.apply();
+        ok = check(filter.getFiltered(3) == st3215::MAX_POSITION, "set limits clamp to MAX_POSITION") && ok;
+        ok = check(!filter.setLimits(3, 300, 200), "reject min > max") && ok;
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "GoalFilter checks passed" << std::endl;
+    return 0;
+}
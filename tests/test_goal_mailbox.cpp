@@ -0,0 +1,103 @@
+#include "st3215/st3215.h"
+#include "st3215/goal_mailbox.h"
+#include "st3215/simulated_port_handler.h"
+#include "st3215/clock.h"
+#include <functional>
+#include <iostream>
+#include <memory>
+
+// Checks GoalMailbox accounting against simulated servos, including a write
+// that fails while the writer posts a newer goal; exits non-zero on failure.
+
+namespace {
+
+bool check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "Check failed: " << what << std::endl;
+    }
+    return condition;
+}
+
+// Fails the next port write after running a hook, to interleave a post()
+// with a sync write the way a planner thread could
+class FailingPort : public st3215::SimulatedPortHandler {
+public:
+    explicit FailingPort(st3215::Clock* clock) : SimulatedPortHandler(clock) {}
+
+    size_t writePort(const std::vector<uint8_t>& packet) override {
+        if (fail_next_) {
+            auto hook = std::move(fail_next_);
+            fail_next_ = nullptr;
+            hook();
+            return 0;
+        }
+        return SimulatedPortHandler::writePort(packet);
+    }
+
+    void failNext(std::function<void()> hook) { fail_next_ = std::move(hook); }
+
+private:
+    std::function<void()> fail_next_;
+};
+
+uint16_t goal(st3215::SimulatedPortHandler* port, uint8_t sts_id) {
+    return static_cast<uint16_t>(port->getRegister(sts_id, st3215::STS_GOAL_POSITION_L).value_or(0) |
+                                 (port->getRegister(sts_id, st3215::STS_GOAL_POSITION_H).value_or(0) << 8));
+}
+
+bool accounted(const st3215::GoalMailbox& mailbox, uint8_t sts_id, uint64_t pending) {
+    return mailbox.getPosted(sts_id) == mailbox.getDelivered(sts_id) + mailbox.getConflated(sts_id) + pending;
+}
+
+}  // namespace
+
+int main() {
+    st3215::VirtualClock clock;
+    auto owned_port = std::make_unique<FailingPort>(&clock);
+    FailingPort* port = owned_port.get();
+    port->addServo(1, 1000);
+
+    auto servo = st3215::ST3215::open(std::move(owned_port));
+    if (!servo) {
+        std::cerr << "Cannot open simulated bus" << std::endl;
+        return 1;
+    }
+
+    st3215::GoalMailbox mailbox(servo.get());
+
+    // Invalid goals are not posted or counted
+    bool ok = check(!mailbox.post(1, 4096), "reject position above MAX_POSITION");
+    ok = check(!mailbox.post(st3215::BROADCAST_ID, 1000), "reject broadcast ID") && ok;
+    ok = check(mailbox.getPosted(1) == 0, "rejected goal not counted") && ok;
+
+    // Overwrite before sending: one conflated, one delivered
+    ok = check(mailbox.post(1, 1100), "post") && ok;
+    ok = check(mailbox.post(1, 1200), "post again") && ok;
+    ok = check(mailbox.txPacket() == st3215::COMM_SUCCESS, "send") && ok;
+    ok = check(goal(port, 1) == 1200, "newest goal sent") && ok;
+    ok = check(mailbox.getConflated(1) == 1 && mailbox.getDelivered(1) == 1, "overwrite counted") && ok;
+
+    // Failed write with no newer goal: re-armed and sent next cycle
+    ok = check(mailbox.post(1, 1300), "post before failed write") && ok;
+    port->failNext([] {});
+    ok = check(mailbox.txPacket() != st3215::COMM_SUCCESS, "failed write reported") && ok;
+    ok = check(accounted(mailbox, 1, 1), "re-armed goal still pending") && ok;
+    ok = check(mailbox.txPacket() == st3215::COMM_SUCCESS && goal(port, 1) == 1300, "re-armed goal sent") && ok;
+
+    // Failed write while the writer posts a newer goal: the taken goal is
+    // conflated and the newer one is sent next cycle
+    ok = check(mailbox.post(1, 1400), "post before racing write") && ok;
+    port->failNext([&] { mailbox.post(1, 1500); });
+    ok = check(mailbox.txPacket() != st3215::COMM_SUCCESS, "racing write reported") && ok;
+    ok = check(mailbox.getConflated(1) == 2, "superseded goal counted as conflated") && ok;
+    ok = check(accounted(mailbox, 1, 1), "newer goal pending") && ok;
+    ok = check(mailbox.txPacket() == st3215::COMM_SUCCESS && goal(port, 1) == 1500, "newer goal sent") && ok;
+    ok = check(accounted(mailbox, 1, 0), "every goal accounted for") && ok;
+    ok = check(mailbox.getTotalConflated() == 2, "total conflated") && ok;
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "GoalMailbox checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "st3215/st3215.h"
+#include "st3215/group_sync_read.h"
+#include "st3215/simulated_port_handler.h"
+#include "st3215/clock.h"
+#include <iostream>
+#include <memory>
+
+// Checks GroupSyncRead slot handling against simulated servos; exits
+// non-zero on failure.
+
+namespace {
+
+bool check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "Check failed: " << what << std::endl;
+    }
+    return condition;
+}
+
+bool available(st3215::GroupSyncRead& group, uint8_t sts_id) {
+    return std::get<0>(group.isAvailable(sts_id, st3215::STS_PRESENT_POSITION_L, 2));
+}
+
+uint32_t position(st3215::GroupSyncRead& group, uint8_t sts_id) {
+    return group.getData(sts_id, st3215::STS_PRESENT_POSITION_L, 2);
+}
+
+}  // namespace
+
+int main() {
+    st3215::VirtualClock clock;
+    auto port = std::make_unique<st3215::SimulatedPortHandler>(&clock);
+    st3215::SimulatedPortHandler* bus = port.get();
+    bus->addServo(1, 1000);
+    bus->addServo(2, 2000);
+    bus->addServo(3, 3000);
+    st3215::ST3215 servo(std::move(port));
+    bool ok = true;
+
+    st3215::GroupSyncRead group(&servo, st3215::STS_PRESENT_POSITION_L, 2);
+    ok = check(group.txRxPacket() == st3215::COMM_NOT_AVAILABLE, "empty group") && ok;
+
+    // IDs added out of order are requested and stored in ID order
+    ok = check(group.addParam(3) && group.addParam(1) && group.addParam(2), "add servos") && ok;
+    ok = check(!group.addParam(2), "reject duplicate servo") && ok;
+    ok = check(group.txRxPacket() == st3215::COMM_SUCCESS, "read all") && ok;
+    ok = check(position(group, 1) == 1000 && position(group, 2) == 2000 && position(group, 3) == 3000,
+               "positions per servo") && ok;
+    ok = check(!available(group, 4), "servo outside the group") && ok;
+    ok = check(!std::get<0>(group.isAvailable(1, st3215::STS_PRESENT_POSITION_L + 1, 2)), "range outside the read") && ok;
+
+    // A missing servo is unavailable; the others still parse
+    bus->removeServo(2);
+    ok = check(group.txRxPacket() != st3215::COMM_SUCCESS, "missing servo reported") && ok;
+    ok = check(available(group, 1) && available(group, 3) && !available(group, 2), "only missing servo unavailable") && ok;
+    ok = check(position(group, 3) == 3000, "intact slot after missing servo") && ok;
+
+    // Removing the servo restores the fast path and keeps slots aligned
+    group.removeParam(2);
+    ok = check(group.txRxPacket() == st3215::COMM_SUCCESS, "read after remove") && ok;
+    ok = check(position(group, 1) == 1000 && position(group, 3) == 3000, "slots after remove") && ok;
+
+    // Nothing answers: no stale data is reported
+    bus->removeServo(1);
+    bus->removeServo(3);
+    ok = check(group.txRxPacket() != st3215::COMM_SUCCESS, "no replies reported") && ok;
+    ok = check(!available(group, 1) && !available(group, 3), "no stale data") && ok;
+
+    group.clearParam();
+    ok = check(group.txRxPacket() == st3215::COMM_NOT_AVAILABLE, "cleared group") && ok;
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "GroupSyncRead checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "st3215/st3215.h"
+#include "st3215/motion_queue.h"
+#include "st3215/simulated_port_handler.h"
+#include "st3215/clock.h"
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+// Checks MotionQueue setpoint streaming against simulated servos in virtual
+// time; exits non-zero on failure.
+
+namespace {
+
+bool check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "Check failed: " << what << std::endl;
+    }
+    return condition;
+}
+
+uint16_t word(st3215::SimulatedPortHandler* port, uint8_t sts_id, uint8_t address) {
+    return static_cast<uint16_t>(port->getRegister(sts_id, address).value_or(0) |
+                                 (port->getRegister(sts_id, address + 1).value_or(0) << 8));
+}
+
+}  // namespace
+
+int main() {
+    st3215::VirtualClock clock;
+    auto owned_port = std::make_unique<st3215::SimulatedPortHandler>(&clock);
+    st3215::SimulatedPortHandler* port = owned_port.get();
+    port->addServo(1, 1000);
+    port->addServo(2, 1000);
+
+    auto servo = st3215::ST3215::open(std::move(owned_port));
+    if (!servo) {
+        std::cerr << "Cannot open simulated bus" << std::endl;
+        return 1;
+    }
+
+    st3215::MotionQueue queue(servo.get(), 100.0);
+    bool ok = check(queue.addServo(1, 1000, 2000.0), "add servo 1");
+    ok = check(queue.addServo(2, 1000, 500.0), "add servo 2") && ok;
+    ok = check(!queue.addServo(3, 1000, 0.0), "reject zero speed limit") && ok;
+    ok = check(!queue.push({{1, 2000}, {3, 2000}}), "reject unknown servo") && ok;
+
+    // Same waypoint for both axes: planned independently, so servo 2
+    // (slower limit) is still moving when servo 1 arrives
+    ok = check(queue.push({{1, 2000}, {2, 2000}}), "push waypoint") && ok;
+    bool zero_speed = false;
+    bool arrived_apart = false;
+    for (int cycle = 0; cycle < 1000 && !queue.isIdle(); ++cycle) {
+        ok = check(queue.tick() == st3215::COMM_SUCCESS, "tick") && ok;
+        for (uint8_t id = 1; id <= 2; ++id) {
+            zero_speed = zero_speed || word(port, id, st3215::STS_GOAL_SPEED_L) == 0;
+        }
+        if (queue.pending(1) == 0 && queue.pending(2) > 0) {
+            arrived_apart = true;
+        }
+        clock.sleepFor(1000.0 / queue.getRate());
+    }
+
+    ok = check(queue.isIdle(), "queue drained") && ok;
+    ok = check(!zero_speed, "no setpoint sent with goal speed 0") && ok;
+    ok = check(arrived_apart, "axes planned independently") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_POSITION_L) == 2000, "final goal servo 1") && ok;
+    ok = check(word(port, 2, st3215::STS_GOAL_POSITION_L) == 2000, "final goal servo 2") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_SPEED_L) == 2000, "final setpoint carries axis limit 1") && ok;
+    ok = check(word(port, 2, st3215::STS_GOAL_SPEED_L) == 500, "final setpoint carries axis limit 2") && ok;
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "MotionQueue checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "st3215/st3215.h"
+#include "st3215/group_sync_read.h"
+#include "st3215/simulated_port_handler.h"
+#include "st3215/clock.h"
+#include <iostream>
+#include <memory>
+
+// Checks register access through ST3215 against simulated servos in
+// whichever profile the library was built with; exits non-zero on failure.
+
+namespace {
+
+constexpr uint8_t SERVO_COUNT = 6;
+
+bool check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "Check failed: " << what << std::endl;
+    }
+    return condition;
+}
+
+}  // namespace
+
+int main() {
+    st3215::VirtualClock clock;
+    auto port = std::make_unique<st3215::SimulatedPortHandler>(&clock);
+    for (uint8_t id = 1; id <= SERVO_COUNT; ++id) {
+        port->addServo(id);
+    }
+
+    auto servo = st3215::ST3215::open(std::move(port));
+    bool ok = check(servo != nullptr, "open simulated bus");
+    ok = check(st3215::ST3215::open(std::unique_ptr<st3215::PortHandler>()) == nullptr, "open without port") && ok;
+    if (!servo) {
+        return 1;
+    }
+
+    ok = check(servo->pingServo(1), "ping present servo") && ok;
+    ok = check(!servo->pingServo(99), "ping absent servo") && ok;
+    ok = check(servo->readPosition(1) == 2048, "read position") && ok;
+    ok = check(!servo->readPosition(99), "read absent servo") && ok;
+    ok = check(servo->setAcceleration(1, 50) && servo->setSpeed(1, 1200), "set speed/acceleration") && ok;
+    ok = check(servo->writePosition(1, 1000), "write position") && ok;
+    ok = check(std::get<0>(servo->read2ByteTxRx(1, st3215::STS_GOAL_POSITION_L)) == 1000, "goal position") && ok;
+    ok = check(std::get<0>(servo->read2ByteTxRx(1, st3215::STS_GOAL_SPEED_L)) == 1200, "goal speed") && ok;
+    ok = check(servo->correctPosition(2, -5), "correct position") && ok;
+    ok = check(servo->readCorrection(2) == -5, "read correction") && ok;
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Register access checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "st3215/st3215.h"
+#include "st3215/simulated_port_handler.h"
+#include "st3215/clock.h"
+#include <iostream>
+#include <memory>
+
+// Checks moveInTime() and syncMoveInTime() against simulated servos:
+// position validation, the optional speed cap and the registers written;
+// exits non-zero on failure.
+
+namespace {
+
+bool check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "Check failed: " << what << std::endl;
+    }
+    return condition;
+}
+
+uint16_t word(st3215::SimulatedPortHandler* port, uint8_t sts_id, uint8_t address) {
+    return static_cast<uint16_t>(port->getRegister(sts_id, address).value_or(0) |
+                                 (port->getRegister(sts_id, address + 1).value_or(0) << 8));
+}
+
+}  // namespace
+
+int main() {
+    st3215::VirtualClock clock;
+    auto owned_port = std::make_unique<st3215::SimulatedPortHandler>(&clock);
+    st3215::SimulatedPortHandler* port = owned_port.get();
+    port->addServo(1);
+    port->addServo(2);
+
+    auto servo = st3215::ST3215::open(std::move(owned_port));
+    if (!servo) {
+        std::cerr << "Cannot open simulated bus" << std::endl;
+        return 1;
+    }
+
+    // Time only: goal speed cleared
+    bool ok = check(servo->moveInTime(1, 1000, 500), "moveInTime");
+    ok = check(word(port, 1, st3215::STS_GOAL_POSITION_L) == 1000, "moveInTime position") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_TIME_L) == 500, "moveInTime time") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_SPEED_L) == 0, "moveInTime clears speed") && ok;
+
+    // Speed cap, clamped to MAX_SPEED
+    ok = check(servo->moveInTime(1, 1200, 500, false, 800), "moveInTime with cap") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_SPEED_L) == 800, "moveInTime speed cap") && ok;
+    ok = check(servo->moveInTime(1, 1200, 500, false, 9000), "moveInTime with large cap") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_SPEED_L) == st3215::MAX_SPEED, "moveInTime cap clamped") && ok;
+
+    // Out-of-range positions are rejected without touching the bus
+    uint64_t writes = port->getWriteCount();
+    ok = check(!servo->moveInTime(1, 5000, 500), "moveInTime rejects position") && ok;
+    ok = check(servo->syncMoveInTime({{1, 1024, 800}, {2, 4096, 800}}) == st3215::COMM_NOT_AVAILABLE,
+               "syncMoveInTime rejects position") && ok;
+    ok = check(port->getWriteCount() == writes, "nothing sent for rejected moves") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_POSITION_L) == 1200, "goal kept after rejected moves") && ok;
+
+    // Sync move with one capped and one uncapped servo
+    ok = check(servo->syncMoveInTime({{1, 1024, 800, 600}, {2, 3072, 800}}) == st3215::COMM_SUCCESS,
+               "syncMoveInTime") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_POSITION_L) == 1024, "sync position 1") && ok;
+    ok = check(word(port, 2, st3215::STS_GOAL_POSITION_L) == 3072, "sync position 2") && ok;
+    ok = check(word(port, 1, st3215::STS_GOAL_SPEED_L) == 600, "sync speed cap") && ok;
+    ok = check(word(port, 2, st3215::STS_GOAL_SPEED_L) == 0, "sync speed cleared") && ok;
+    ok = check(word(port, 2, st3215::STS_GOAL_TIME_L) == 800, "sync time") && ok;
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Timed move checks passed" << std::endl;
+    return 0;
+}